@@ -0,0 +1,191 @@
+#include "StringInterner.h"
+
+#include <cstring>
+#include <functional>
+
+#if defined(_MSC_VER)
+#    include <intrin.h>
+#endif
+
+using namespace vsg;
+
+namespace
+{
+    constexpr std::size_t chunkSize = 65536;
+
+    uint64_t hashString(std::string_view str)
+    {
+        // spread std::hash over all 64 bits, the low bits index the table and the high bits are the slot tag
+        return static_cast<uint64_t>(std::hash<std::string_view>()(str)) * 0x9E3779B97F4A7C15ull;
+    }
+
+    unsigned int highestBit(uint64_t v)
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanReverse64(&index, v);
+        return static_cast<unsigned int>(index);
+#else
+        return 63u - static_cast<unsigned int>(__builtin_clzll(v));
+#endif
+    }
+
+    inline uint32_t tag(uint64_t hash) { return static_cast<uint32_t>(hash >> 32); }
+    inline uint64_t slotValue(uint64_t hash, StringInterner::Id id) { return (static_cast<uint64_t>(tag(hash)) << 32) | (static_cast<uint64_t>(id) + 1); }
+    inline StringInterner::Id slotId(uint64_t slot) { return static_cast<StringInterner::Id>((slot & 0xffffffff) - 1); }
+}
+
+StringInterner::Table::Table(std::size_t capacity) :
+    mask(capacity - 1),
+    slots(new std::atomic<uint64_t>[capacity])
+{
+    for (std::size_t i = 0; i < capacity; ++i) slots[i].store(0, std::memory_order_relaxed);
+}
+
+StringInterner::StringInterner(std::size_t initialCapacity)
+{
+    // keep the load factor at or below a half
+    std::size_t capacity = 16;
+    while (capacity < initialCapacity * 2) capacity *= 2;
+
+    _tables.emplace_back(new Table(capacity));
+    _table.store(_tables.back().get(), std::memory_order_release);
+
+    for (auto& block : _blocks) block.store(nullptr, std::memory_order_relaxed);
+}
+
+StringInterner::~StringInterner()
+{
+    for (auto& block : _blocks) delete[] block.load(std::memory_order_relaxed);
+}
+
+StringInterner& StringInterner::instance()
+{
+    static StringInterner s_interner;
+    return s_interner;
+}
+
+const StringInterner::Entry* StringInterner::entry(Id id) const
+{
+    uint64_t v = static_cast<uint64_t>(id) + (1u << firstBlockBits);
+    unsigned int bit = highestBit(v);
+    const Entry* block = _blocks[bit - firstBlockBits].load(std::memory_order_acquire);
+    return block + (v - (uint64_t(1) << bit));
+}
+
+StringInterner::Id StringInterner::find(const Table& table, std::string_view str, uint64_t hash) const
+{
+    uint32_t t = tag(hash);
+    for (std::size_t i = hash & table.mask;; i = (i + 1) & table.mask)
+    {
+        uint64_t slot = table.slots[i].load(std::memory_order_acquire);
+        if (slot == 0) return invalid;
+        if (static_cast<uint32_t>(slot >> 32) != t) continue;
+
+        Id id = slotId(slot);
+        const Entry* e = entry(id);
+        if (e->length == str.size() && std::memcmp(e->data, str.data(), str.size()) == 0) return id;
+    }
+}
+
+StringInterner::Id StringInterner::find(std::string_view str) const
+{
+    return find(*_table.load(std::memory_order_acquire), str, hashString(str));
+}
+
+std::string_view StringInterner::view(Id id) const
+{
+    if (id >= size()) return {};
+    const Entry* e = entry(id);
+    return std::string_view(e->data, e->length);
+}
+
+StringInterner::Id StringInterner::intern(std::string_view str)
+{
+    uint64_t hash = hashString(str);
+
+    // fast path, lock-free lookup of an existing string
+    Id id = find(*_table.load(std::memory_order_acquire), str, hash);
+    if (id != invalid) return id;
+
+    std::lock_guard<std::mutex> guard(_mutex);
+
+    // another thread may have added the string or grown the table since the lock-free lookup
+    Table* table = _table.load(std::memory_order_relaxed);
+    id = find(*table, str, hash);
+    if (id != invalid) return id;
+
+    std::size_t count = _size.load(std::memory_order_relaxed);
+    if (count >= invalid) return invalid;
+    id = static_cast<Id>(count);
+
+    // allocate the next entry block when the id starts a new one
+    uint64_t v = static_cast<uint64_t>(id) + (1u << firstBlockBits);
+    unsigned int bit = highestBit(v);
+    Entry* block = _blocks[bit - firstBlockBits].load(std::memory_order_relaxed);
+    if (!block)
+    {
+        block = new Entry[std::size_t(1) << bit];
+        _blocks[bit - firstBlockBits].store(block, std::memory_order_release);
+    }
+
+    Entry& e = block[v - (uint64_t(1) << bit)];
+    e.data = store(str);
+    e.length = str.size();
+    e.hash = hash;
+
+    // grow by rehashing into a new table, the old table is retired rather than deleted as lock-free readers may still be probing it
+    if ((count + 1) * 2 > table->mask + 1)
+    {
+        _tables.emplace_back(new Table((table->mask + 1) * 2));
+        table = _tables.back().get();
+        for (Id i = 0; i < id; ++i) insert(*table, i, entry(i)->hash);
+        insert(*table, id, hash);
+
+        _size.store(count + 1, std::memory_order_release);
+        _table.store(table, std::memory_order_release);
+    }
+    else
+    {
+        // publish the entry before the slot that refers to it
+        _size.store(count + 1, std::memory_order_release);
+        insert(*table, id, hash);
+    }
+
+    return id;
+}
+
+void StringInterner::insert(Table& table, Id id, uint64_t hash)
+{
+    std::size_t i = hash & table.mask;
+    while (table.slots[i].load(std::memory_order_relaxed) != 0) i = (i + 1) & table.mask;
+    table.slots[i].store(slotValue(hash, id), std::memory_order_release);
+}
+
+const char* StringInterner::store(std::string_view str)
+{
+    std::size_t length = str.size() + 1;
+
+    // long strings get their own allocation rather than wasting the rest of a chunk
+    char* data = nullptr;
+    if (length > chunkSize / 4)
+    {
+        _chunks.emplace_back(new char[length]);
+        data = _chunks.back().get();
+    }
+    else
+    {
+        if (!_chunk || _chunkUsed + length > chunkSize)
+        {
+            _chunks.emplace_back(new char[chunkSize]);
+            _chunk = _chunks.back().get();
+            _chunkUsed = 0;
+        }
+        data = _chunk + _chunkUsed;
+        _chunkUsed += length;
+    }
+
+    std::memcpy(data, str.data(), str.size());
+    data[str.size()] = 0;
+    return data;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+namespace vsg
+{
+
+    //
+    // StringInterner maps strings to small integer ids, for property keys and other names that are compared far more often than created.
+    // Looking up a string that is already interned, and mapping an id back to its string, are lock-free: the open addressing hash table
+    // and the entries are only ever appended to, with each new entry published by an atomic store. Only adding a new string takes the mutex.
+    // Interned characters are never moved or freed while the interner exists, so the returned string_view handles stay valid.
+    //
+    class StringInterner
+    {
+    public:
+        using Id = uint32_t;
+        static constexpr Id invalid = 0xffffffff;
+
+        explicit StringInterner(std::size_t initialCapacity = 1024);
+        ~StringInterner();
+
+        StringInterner(const StringInterner&) = delete;
+        StringInterner& operator=(const StringInterner&) = delete;
+
+        // return the id of str, adding it if not already interned. Lock-free when str is already interned.
+        Id intern(std::string_view str);
+
+        // return the id of str, or invalid if it hasn't been interned. Lock-free.
+        Id find(std::string_view str) const;
+
+        // return the interned string for id, or an empty view for an invalid id. The characters are null terminated. Lock-free.
+        std::string_view view(Id id) const;
+
+        // number of interned strings, ids are 0 to size()-1 in the order they were interned
+        std::size_t size() const { return _size.load(std::memory_order_acquire); }
+
+        // process wide interner for property keys
+        static StringInterner& instance();
+
+    protected:
+        struct Entry
+        {
+            const char* data = nullptr;
+            std::size_t length = 0;
+            uint64_t hash = 0;
+        };
+
+        // each slot holds the upper 32 bits of the hash and id+1, 0 marks an empty slot, so most probes compare without touching the entry
+        struct Table
+        {
+            explicit Table(std::size_t capacity);
+
+            std::size_t mask;
+            std::unique_ptr<std::atomic<uint64_t>[]> slots;
+        };
+
+        // entries are held in blocks that double in size, so an id maps to its block with a bit scan and blocks never move
+        static constexpr unsigned int firstBlockBits = 8;
+        static constexpr unsigned int maxBlocks = 32 - firstBlockBits + 1;
+
+        const Entry* entry(Id id) const;
+        Id find(const Table& table, std::string_view str, uint64_t hash) const;
+        void insert(Table& table, Id id, uint64_t hash);
+        const char* store(std::string_view str);
+
+        std::atomic<Table*> _table;
+        std::atomic<Entry*> _blocks[maxBlocks];
+        std::atomic<std::size_t> _size{0};
+
+        // only accessed by writers holding the mutex, retired tables are kept as readers may still be probing them
+        std::mutex _mutex;
+        std::vector<std::unique_ptr<Table>> _tables;
+        std::vector<std::unique_ptr<char[]>> _chunks;
+        char* _chunk = nullptr;
+        std::size_t _chunkUsed = 0;
+    };
+
+} // namespace vsg
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <string>
+
+// interns strings through two std::maps guarded by a single mutex, the baseline vsgarraysbenchmark compares vsg::StringInterner against.
+struct Unique
+{
+    using StringIndexMap = std::map< std::string, std::size_t >;
+    using IndexStringMap = std::map< std::size_t, std::string >;
+
+    std::mutex _mutex;
+    StringIndexMap _stringIndexMap;
+    IndexStringMap _indexStringMap;
+
+    std::size_t getIndex(const std::string& name)
+    {
+        std::lock_guard<std::mutex> guard(_mutex);
+        StringIndexMap::iterator  itr = _stringIndexMap.find(name);
+        if (itr != _stringIndexMap.end()) return itr->second;
+
+        std::size_t s = _stringIndexMap.size();
+        _stringIndexMap[name] = s;
+        _indexStringMap[s] = name;
+         return s;
+    }
+
+    std::string getName(std::size_t index)
+    {
+        std::lock_guard<std::mutex> guard(_mutex);
+        IndexStringMap::iterator  itr = _indexStringMap.find(index);
+        if (itr != _indexStringMap.end()) return itr->second;
+        return std::string();
+    }
+
+};
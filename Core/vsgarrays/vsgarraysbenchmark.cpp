@@ -0,0 +1,118 @@
+#include <vsg/all.h>
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <random>
+#include <atomic>
+
+#include "StringInterner.h"
+#include "Unique.h"
+
+// run function(threadIndex) on numThreads threads started together, returning the wall clock time in milliseconds
+template<typename F>
+double run(unsigned int numThreads, F function)
+{
+    std::atomic<unsigned int> ready(0);
+    std::atomic<bool> go(false);
+
+    std::vector<std::thread> threads;
+    for(unsigned int t=0; t<numThreads; ++t)
+    {
+        threads.emplace_back([&, t]() {
+            ++ready;
+            while(!go.load(std::memory_order_acquire)) std::this_thread::yield();
+            function(t);
+        });
+    }
+
+    while(ready.load() < numThreads) std::this_thread::yield();
+
+    auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for(auto& thread : threads) thread.join();
+    return std::chrono::duration<double, std::chrono::milliseconds::period>(std::chrono::steady_clock::now() - start).count();
+}
+
+void report(const char* name, std::size_t count, double baselineTime, double duration, std::size_t errors)
+{
+    std::cout<<"    "<<name<<"\t"<<duration<<"ms\t"<<double(count)/(duration*1000.0)<<" M/s\tspeedup "<<baselineTime/duration<<"\terrors "<<errors<<std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    vsg::CommandLine arguments(&argc, argv);
+    auto numKeys = arguments.value<std::size_t>(1000, {"-k", "--keys"});
+    auto numOperations = arguments.value<std::size_t>(1000000, {"-o", "--operations"});
+    auto maxThreads = arguments.value(std::max(1u, std::thread::hardware_concurrency()), {"-t", "--threads"});
+    auto nameInterval = arguments.value<std::size_t>(4, {"-n", "--name-interval"});
+    if (arguments.errors()) return arguments.writeErrorMessages(std::cerr);
+
+    if (nameInterval == 0) nameInterval = 1;
+
+    // property key style names
+    std::vector<std::string> keys;
+    for(std::size_t i=0; i<numKeys; ++i) keys.push_back("property_" + std::to_string(i) + "_key");
+
+    // each thread looks up keys in its own random order, the interners start empty so the first lookups of each run also add the keys
+    std::vector<std::vector<uint32_t>> sequences(maxThreads);
+    std::mt19937 generator(0);
+    std::uniform_int_distribution<uint32_t> randomKey(0, static_cast<uint32_t>(numKeys-1));
+    for(auto& sequence : sequences)
+    {
+        sequence.resize(numOperations);
+        for(auto& k : sequence) k = randomKey(generator);
+    }
+
+    std::cout<<"vsgarraysbenchmark "<<numKeys<<" keys, "<<numOperations<<" lookups per thread, name read every "<<nameInterval<<" lookups"<<std::endl;
+
+    // double the number of threads each run, finishing with maxThreads
+    std::vector<unsigned int> threadCounts;
+    for(unsigned int numThreads=1; numThreads<maxThreads; numThreads*=2) threadCounts.push_back(numThreads);
+    threadCounts.push_back(maxThreads);
+
+    for(auto numThreads : threadCounts)
+    {
+        std::size_t count = numOperations * numThreads;
+        std::cout<<"\n"<<numThreads<<" threads"<<std::endl;
+
+        // errors count names that don't read back as the key looked up
+        std::atomic<std::size_t> uniqueErrors(0);
+        Unique unique;
+        double uniqueTime = run(numThreads, [&](unsigned int t) {
+            std::size_t errors = 0;
+            auto& sequence = sequences[t];
+            for(std::size_t i=0; i<numOperations; ++i)
+            {
+                auto& key = keys[sequence[i]];
+                auto index = unique.getIndex(key);
+                if ((i % nameInterval)==0 && unique.getName(index) != key) ++errors;
+            }
+            uniqueErrors += errors;
+        });
+        report("Unique", count, uniqueTime, uniqueTime, uniqueErrors);
+
+        std::atomic<std::size_t> internerErrors(0);
+        vsg::StringInterner interner;
+        double internerTime = run(numThreads, [&](unsigned int t) {
+            std::size_t errors = 0;
+            auto& sequence = sequences[t];
+            for(std::size_t i=0; i<numOperations; ++i)
+            {
+                auto& key = keys[sequence[i]];
+                auto id = interner.intern(key);
+                if ((i % nameInterval)==0 && interner.view(id) != key) ++errors;
+            }
+            internerErrors += errors;
+        });
+
+        // every key must have been interned exactly once
+        if (interner.size() > numKeys) internerErrors += interner.size() - numKeys;
+
+        report("StringInterner", count, uniqueTime, internerTime, internerErrors);
+    }
+
+    return 0;
+}
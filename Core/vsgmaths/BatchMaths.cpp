@@ -0,0 +1,589 @@
+#include "BatchMaths.h"
+
+#include <atomic>
+#include <bitset>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#    define BATCH_MATHS_X86
+#    include <immintrin.h>
+#    if defined(_MSC_VER)
+#        include <intrin.h>
+#        define BATCH_MATHS_AVX2_TARGET
+#    else
+#        define BATCH_MATHS_AVX2_TARGET __attribute__((target("avx2,fma")))
+#    endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#    define BATCH_MATHS_NEON
+#    include <arm_neon.h>
+#endif
+
+using namespace vsg;
+using namespace vsg::batch;
+
+// the kernels load and store vec3, mat4, plane and sphere as tightly packed floats
+static_assert(sizeof(vec3) == 3 * sizeof(float), "vec3 must be 3 packed floats");
+static_assert(sizeof(mat4) == 16 * sizeof(float), "mat4 must be 16 packed floats");
+static_assert(sizeof(sphere) == 4 * sizeof(float), "sphere must be 4 packed floats");
+
+namespace
+{
+    template<typename T>
+    const float* floats(const T& value) { return reinterpret_cast<const float*>(&value); }
+
+    template<typename T>
+    float* floats(T& value) { return reinterpret_cast<float*>(&value); }
+
+    struct Kernels
+    {
+        void (*transform)(const mat4& matrix, const vec3* points, vec3* results, std::size_t count);
+        void (*multiply)(const mat4& lhs, const mat4* matrices, mat4* results, std::size_t count);
+        void (*intersect)(const plane* planes, std::size_t numPlanes, const sphere* spheres, uint8_t* results, std::size_t count);
+        void (*cull)(const plane* planes, std::size_t numPlanes, const float* x, const float* y, const float* z, const float* radius, std::size_t first, std::size_t count, uint64_t* mask);
+    };
+
+    // set the visible bits of the spheres from first, the mask must be cleared beforehand
+    inline void setBits(uint64_t* mask, std::size_t first, uint64_t bits)
+    {
+        mask[first / 64] |= bits << (first % 64);
+    }
+
+    /////////////////////////////////////////////////////////////////////////////////////////////////////
+    //
+    // scalar kernels, the reference implementations and the tails of the SIMD kernels
+    //
+    void transform_scalar(const mat4& matrix, const vec3* points, vec3* results, std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; ++i) results[i] = matrix * points[i];
+    }
+
+    void multiply_scalar(const mat4& lhs, const mat4* matrices, mat4* results, std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; ++i) results[i] = lhs * matrices[i];
+    }
+
+    void intersect_scalar(const plane* planes, std::size_t numPlanes, const sphere* spheres, uint8_t* results, std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            uint8_t inside = 1;
+            for (std::size_t p = 0; p < numPlanes && inside; ++p)
+            {
+                if (distance(planes[p], spheres[i].center) < -spheres[i].radius) inside = 0;
+            }
+            results[i] = inside;
+        }
+    }
+
+    void cull_scalar(const plane* planes, std::size_t numPlanes, const float* x, const float* y, const float* z, const float* radius, std::size_t first, std::size_t count, uint64_t* mask)
+    {
+        for (std::size_t i = first; i < count; ++i)
+        {
+            bool inside = true;
+            for (std::size_t p = 0; p < numPlanes && inside; ++p)
+            {
+                auto& pl = planes[p];
+                inside = (pl.n.x * x[i] + pl.n.y * y[i] + pl.n.z * z[i] + pl.p) >= -radius[i];
+            }
+            if (inside) setBits(mask, i, 1);
+        }
+    }
+
+    const Kernels scalarKernels{transform_scalar, multiply_scalar, intersect_scalar, cull_scalar};
+
+#ifdef BATCH_MATHS_X86
+    /////////////////////////////////////////////////////////////////////////////////////////////////////
+    //
+    // SSE kernels, SSE2 is part of the x86-64 baseline so needs no runtime check
+    //
+
+    // 4 packed vec3 {x0 y0 z0 x1} {y1 z1 x2 y2} {z2 x3 y3 z3} to {x0 x1 x2 x3} {y0 y1 y2 y3} {z0 z1 z2 z3}, and back.
+    // The shuffles only work within 128 bit lanes, so the same sequence deinterleaves two sets of 4 points in AVX registers.
+#    define BATCH_DEINTERLEAVE3(shuffle, a, b, c, x, y, z)                  \
+        {                                                                  \
+            auto t0 = shuffle(b, c, _MM_SHUFFLE(2, 1, 3, 2));              \
+            auto t1 = shuffle(a, b, _MM_SHUFFLE(1, 0, 2, 1));              \
+            x = shuffle(a, t0, _MM_SHUFFLE(2, 0, 3, 0));                   \
+            y = shuffle(t1, t0, _MM_SHUFFLE(3, 1, 2, 0));                  \
+            z = shuffle(t1, c, _MM_SHUFFLE(3, 0, 3, 1));                   \
+        }
+
+#    define BATCH_INTERLEAVE3(shuffle, unpacklo, unpackhi, x, y, z, a, b, c) \
+        {                                                                    \
+            auto xy_lo = unpacklo(x, y);                                     \
+            auto xy_hi = unpackhi(x, y);                                     \
+            a = shuffle(xy_lo, shuffle(z, xy_lo, _MM_SHUFFLE(2, 2, 0, 0)), _MM_SHUFFLE(2, 0, 1, 0)); \
+            b = shuffle(shuffle(xy_lo, z, _MM_SHUFFLE(1, 1, 3, 3)), xy_hi, _MM_SHUFFLE(1, 0, 2, 0)); \
+            c = shuffle(shuffle(z, xy_hi, _MM_SHUFFLE(2, 2, 2, 2)), shuffle(xy_hi, z, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(2, 0, 2, 0)); \
+        }
+
+    void transform_sse(const mat4& matrix, const vec3* points, vec3* results, std::size_t count)
+    {
+        const float* m = floats(matrix);
+        __m128 mv[16];
+        for (int i = 0; i < 16; ++i) mv[i] = _mm_set1_ps(m[i]);
+
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            const float* in = floats(points[i]);
+            __m128 a = _mm_loadu_ps(in), b = _mm_loadu_ps(in + 4), c = _mm_loadu_ps(in + 8);
+            __m128 x, y, z;
+            BATCH_DEINTERLEAVE3(_mm_shuffle_ps, a, b, c, x, y, z)
+
+            // m is column major, m[column * 4 + row]
+            __m128 rx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(mv[0], x), _mm_mul_ps(mv[4], y)), _mm_add_ps(_mm_mul_ps(mv[8], z), mv[12]));
+            __m128 ry = _mm_add_ps(_mm_add_ps(_mm_mul_ps(mv[1], x), _mm_mul_ps(mv[5], y)), _mm_add_ps(_mm_mul_ps(mv[9], z), mv[13]));
+            __m128 rz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(mv[2], x), _mm_mul_ps(mv[6], y)), _mm_add_ps(_mm_mul_ps(mv[10], z), mv[14]));
+            __m128 rw = _mm_add_ps(_mm_add_ps(_mm_mul_ps(mv[3], x), _mm_mul_ps(mv[7], y)), _mm_add_ps(_mm_mul_ps(mv[11], z), mv[15]));
+
+            __m128 inv = _mm_div_ps(_mm_set1_ps(1.0f), rw);
+            rx = _mm_mul_ps(rx, inv);
+            ry = _mm_mul_ps(ry, inv);
+            rz = _mm_mul_ps(rz, inv);
+
+            BATCH_INTERLEAVE3(_mm_shuffle_ps, _mm_unpacklo_ps, _mm_unpackhi_ps, rx, ry, rz, a, b, c)
+            float* out = floats(results[i]);
+            _mm_storeu_ps(out, a);
+            _mm_storeu_ps(out + 4, b);
+            _mm_storeu_ps(out + 8, c);
+        }
+
+        transform_scalar(matrix, points + i, results + i, count - i);
+    }
+
+    void multiply_sse(const mat4& lhs, const mat4* matrices, mat4* results, std::size_t count)
+    {
+        const float* l = floats(lhs);
+        __m128 l0 = _mm_loadu_ps(l), l1 = _mm_loadu_ps(l + 4), l2 = _mm_loadu_ps(l + 8), l3 = _mm_loadu_ps(l + 12);
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const float* r = floats(matrices[i]);
+            float* out = floats(results[i]);
+
+            // column c of the result is lhs * column c of rhs
+            for (int c = 0; c < 4; ++c)
+            {
+                __m128 col = _mm_loadu_ps(r + c * 4);
+                __m128 result = _mm_mul_ps(l0, _mm_shuffle_ps(col, col, _MM_SHUFFLE(0, 0, 0, 0)));
+                result = _mm_add_ps(result, _mm_mul_ps(l1, _mm_shuffle_ps(col, col, _MM_SHUFFLE(1, 1, 1, 1))));
+                result = _mm_add_ps(result, _mm_mul_ps(l2, _mm_shuffle_ps(col, col, _MM_SHUFFLE(2, 2, 2, 2))));
+                result = _mm_add_ps(result, _mm_mul_ps(l3, _mm_shuffle_ps(col, col, _MM_SHUFFLE(3, 3, 3, 3))));
+                _mm_storeu_ps(out + c * 4, result);
+            }
+        }
+    }
+
+    void intersect_sse(const plane* planes, std::size_t numPlanes, const sphere* spheres, uint8_t* results, std::size_t count)
+    {
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            const float* s = floats(spheres[i]);
+            __m128 x = _mm_loadu_ps(s), y = _mm_loadu_ps(s + 4), z = _mm_loadu_ps(s + 8), r = _mm_loadu_ps(s + 12);
+            _MM_TRANSPOSE4_PS(x, y, z, r);
+            __m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), r);
+
+            __m128 outside = _mm_setzero_ps();
+            for (std::size_t p = 0; p < numPlanes; ++p)
+            {
+                auto& pl = planes[p];
+                __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(pl.n.x), x), _mm_mul_ps(_mm_set1_ps(pl.n.y), y)), _mm_add_ps(_mm_mul_ps(_mm_set1_ps(pl.n.z), z), _mm_set1_ps(pl.p)));
+                outside = _mm_or_ps(outside, _mm_cmplt_ps(d, negativeRadius));
+            }
+
+            int mask = _mm_movemask_ps(outside);
+            results[i] = (mask & 1) ? 0 : 1;
+            results[i + 1] = (mask & 2) ? 0 : 1;
+            results[i + 2] = (mask & 4) ? 0 : 1;
+            results[i + 3] = (mask & 8) ? 0 : 1;
+        }
+
+        intersect_scalar(planes, numPlanes, spheres + i, results + i, count - i);
+    }
+
+    void cull_sse(const plane* planes, std::size_t numPlanes, const float* x, const float* y, const float* z, const float* radius, std::size_t first, std::size_t count, uint64_t* mask)
+    {
+        std::size_t i = first;
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128 sx = _mm_loadu_ps(x + i), sy = _mm_loadu_ps(y + i), sz = _mm_loadu_ps(z + i);
+            __m128 negativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(radius + i));
+
+            int inside = 0xf;
+            for (std::size_t p = 0; p < numPlanes && inside; ++p)
+            {
+                auto& pl = planes[p];
+                __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(pl.n.x), sx), _mm_mul_ps(_mm_set1_ps(pl.n.y), sy)), _mm_add_ps(_mm_mul_ps(_mm_set1_ps(pl.n.z), sz), _mm_set1_ps(pl.p)));
+                inside &= _mm_movemask_ps(_mm_cmpge_ps(d, negativeRadius));
+            }
+            setBits(mask, i, static_cast<uint64_t>(inside));
+        }
+
+        cull_scalar(planes, numPlanes, x, y, z, radius, i, count, mask);
+    }
+
+    const Kernels sseKernels{transform_sse, multiply_sse, intersect_sse, cull_sse};
+
+    /////////////////////////////////////////////////////////////////////////////////////////////////////
+    //
+    // AVX2 + FMA kernels, compiled for the AVX2 target only so the rest of the file runs on any x86-64 CPU
+    //
+    BATCH_MATHS_AVX2_TARGET inline __m256 load2x128(const float* lo, const float* hi)
+    {
+        return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(lo)), _mm_loadu_ps(hi), 1);
+    }
+
+    BATCH_MATHS_AVX2_TARGET inline void store2x128(float* lo, float* hi, __m256 v)
+    {
+        _mm_storeu_ps(lo, _mm256_castps256_ps128(v));
+        _mm_storeu_ps(hi, _mm256_extractf128_ps(v, 1));
+    }
+
+    BATCH_MATHS_AVX2_TARGET void transform_avx2(const mat4& matrix, const vec3* points, vec3* results, std::size_t count)
+    {
+        const float* m = floats(matrix);
+        __m256 mv[16];
+        for (int i = 0; i < 16; ++i) mv[i] = _mm256_set1_ps(m[i]);
+
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            // low lanes hold points i..i+3, high lanes i+4..i+7
+            const float* in = floats(points[i]);
+            __m256 a = load2x128(in, in + 12), b = load2x128(in + 4, in + 16), c = load2x128(in + 8, in + 20);
+            __m256 x, y, z;
+            BATCH_DEINTERLEAVE3(_mm256_shuffle_ps, a, b, c, x, y, z)
+
+            __m256 rx = _mm256_fmadd_ps(mv[0], x, _mm256_fmadd_ps(mv[4], y, _mm256_fmadd_ps(mv[8], z, mv[12])));
+            __m256 ry = _mm256_fmadd_ps(mv[1], x, _mm256_fmadd_ps(mv[5], y, _mm256_fmadd_ps(mv[9], z, mv[13])));
+            __m256 rz = _mm256_fmadd_ps(mv[2], x, _mm256_fmadd_ps(mv[6], y, _mm256_fmadd_ps(mv[10], z, mv[14])));
+            __m256 rw = _mm256_fmadd_ps(mv[3], x, _mm256_fmadd_ps(mv[7], y, _mm256_fmadd_ps(mv[11], z, mv[15])));
+
+            __m256 inv = _mm256_div_ps(_mm256_set1_ps(1.0f), rw);
+            rx = _mm256_mul_ps(rx, inv);
+            ry = _mm256_mul_ps(ry, inv);
+            rz = _mm256_mul_ps(rz, inv);
+
+            BATCH_INTERLEAVE3(_mm256_shuffle_ps, _mm256_unpacklo_ps, _mm256_unpackhi_ps, rx, ry, rz, a, b, c)
+            float* out = floats(results[i]);
+            store2x128(out, out + 12, a);
+            store2x128(out + 4, out + 16, b);
+            store2x128(out + 8, out + 20, c);
+        }
+
+        transform_sse(matrix, points + i, results + i, count - i);
+    }
+
+    BATCH_MATHS_AVX2_TARGET void multiply_avx2(const mat4& lhs, const mat4* matrices, mat4* results, std::size_t count)
+    {
+        // lhs columns duplicated in both lanes, so each 256 bit register computes two result columns
+        const float* l = floats(lhs);
+        __m256 l0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(l));
+        __m256 l1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(l + 4));
+        __m256 l2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(l + 8));
+        __m256 l3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(l + 12));
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const float* r = floats(matrices[i]);
+            float* out = floats(results[i]);
+
+            __m256 c01 = _mm256_loadu_ps(r);
+            __m256 c23 = _mm256_loadu_ps(r + 8);
+
+            __m256 r01 = _mm256_mul_ps(l0, _mm256_permute_ps(c01, 0x00));
+            r01 = _mm256_fmadd_ps(l1, _mm256_permute_ps(c01, 0x55), r01);
+            r01 = _mm256_fmadd_ps(l2, _mm256_permute_ps(c01, 0xaa), r01);
+            r01 = _mm256_fmadd_ps(l3, _mm256_permute_ps(c01, 0xff), r01);
+
+            __m256 r23 = _mm256_mul_ps(l0, _mm256_permute_ps(c23, 0x00));
+            r23 = _mm256_fmadd_ps(l1, _mm256_permute_ps(c23, 0x55), r23);
+            r23 = _mm256_fmadd_ps(l2, _mm256_permute_ps(c23, 0xaa), r23);
+            r23 = _mm256_fmadd_ps(l3, _mm256_permute_ps(c23, 0xff), r23);
+
+            _mm256_storeu_ps(out, r01);
+            _mm256_storeu_ps(out + 8, r23);
+        }
+    }
+
+    BATCH_MATHS_AVX2_TARGET void intersect_avx2(const plane* planes, std::size_t numPlanes, const sphere* spheres, uint8_t* results, std::size_t count)
+    {
+        std::size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            // transpose two 4x4 blocks, low lanes hold spheres i..i+3, high lanes i+4..i+7
+            const float* s = floats(spheres[i]);
+            __m256 s0 = load2x128(s, s + 16), s1 = load2x128(s + 4, s + 20), s2 = load2x128(s + 8, s + 24), s3 = load2x128(s + 12, s + 28);
+            __m256 t0 = _mm256_unpacklo_ps(s0, s1), t1 = _mm256_unpacklo_ps(s2, s3);
+            __m256 t2 = _mm256_unpackhi_ps(s0, s1), t3 = _mm256_unpackhi_ps(s2, s3);
+            __m256 x = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+            __m256 y = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+            __m256 z = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+            __m256 r = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+            __m256 negativeRadius = _mm256_sub_ps(_mm256_setzero_ps(), r);
+
+            __m256 outside = _mm256_setzero_ps();
+            for (std::size_t p = 0; p < numPlanes; ++p)
+            {
+                auto& pl = planes[p];
+                __m256 d = _mm256_fmadd_ps(_mm256_set1_ps(pl.n.x), x, _mm256_fmadd_ps(_mm256_set1_ps(pl.n.y), y, _mm256_fmadd_ps(_mm256_set1_ps(pl.n.z), z, _mm256_set1_ps(pl.p))));
+                outside = _mm256_or_ps(outside, _mm256_cmp_ps(d, negativeRadius, _CMP_LT_OQ));
+            }
+
+            int mask = _mm256_movemask_ps(outside);
+            for (int b = 0; b < 8; ++b) results[i + b] = (mask & (1 << b)) ? 0 : 1;
+        }
+
+        intersect_sse(planes, numPlanes, spheres + i, results + i, count - i);
+    }
+
+    BATCH_MATHS_AVX2_TARGET void cull_avx2(const plane* planes, std::size_t numPlanes, const float* x, const float* y, const float* z, const float* radius, std::size_t first, std::size_t count, uint64_t* mask)
+    {
+        std::size_t i = first;
+        for (; i + 8 <= count; i += 8)
+        {
+            __m256 sx = _mm256_loadu_ps(x + i), sy = _mm256_loadu_ps(y + i), sz = _mm256_loadu_ps(z + i);
+            __m256 negativeRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(radius + i));
+
+            int inside = 0xff;
+            for (std::size_t p = 0; p < numPlanes && inside; ++p)
+            {
+                auto& pl = planes[p];
+                __m256 d = _mm256_fmadd_ps(_mm256_set1_ps(pl.n.x), sx, _mm256_fmadd_ps(_mm256_set1_ps(pl.n.y), sy, _mm256_fmadd_ps(_mm256_set1_ps(pl.n.z), sz, _mm256_set1_ps(pl.p))));
+                inside &= _mm256_movemask_ps(_mm256_cmp_ps(d, negativeRadius, _CMP_GE_OQ));
+            }
+            setBits(mask, i, static_cast<uint64_t>(inside));
+        }
+
+        cull_sse(planes, numPlanes, x, y, z, radius, i, count, mask);
+    }
+
+    const Kernels avx2Kernels{transform_avx2, multiply_avx2, intersect_avx2, cull_avx2};
+
+    bool cpuSupportsAVX2()
+    {
+#    if defined(_MSC_VER)
+        int info[4];
+        __cpuid(info, 1);
+        bool fma = (info[2] & (1 << 12)) != 0;
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        if (!fma || !osxsave || (_xgetbv(0) & 0x6) != 0x6) return false;
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#    else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#    endif
+    }
+#endif
+
+#ifdef BATCH_MATHS_NEON
+    /////////////////////////////////////////////////////////////////////////////////////////////////////
+    //
+    // NEON kernels, NEON is part of the AArch64 baseline so needs no runtime check
+    //
+    void transform_neon(const mat4& matrix, const vec3* points, vec3* results, std::size_t count)
+    {
+        const float* m = floats(matrix);
+        float32x4_t mv[16];
+        for (int i = 0; i < 16; ++i) mv[i] = vdupq_n_f32(m[i]);
+
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            float32x4x3_t xyz = vld3q_f32(floats(points[i]));
+            float32x4_t x = xyz.val[0], y = xyz.val[1], z = xyz.val[2];
+
+            float32x4_t rx = vfmaq_f32(vfmaq_f32(vfmaq_f32(mv[12], mv[8], z), mv[4], y), mv[0], x);
+            float32x4_t ry = vfmaq_f32(vfmaq_f32(vfmaq_f32(mv[13], mv[9], z), mv[5], y), mv[1], x);
+            float32x4_t rz = vfmaq_f32(vfmaq_f32(vfmaq_f32(mv[14], mv[10], z), mv[6], y), mv[2], x);
+            float32x4_t rw = vfmaq_f32(vfmaq_f32(vfmaq_f32(mv[15], mv[11], z), mv[7], y), mv[3], x);
+
+            float32x4_t inv = vdivq_f32(vdupq_n_f32(1.0f), rw);
+            xyz.val[0] = vmulq_f32(rx, inv);
+            xyz.val[1] = vmulq_f32(ry, inv);
+            xyz.val[2] = vmulq_f32(rz, inv);
+            vst3q_f32(floats(results[i]), xyz);
+        }
+
+        transform_scalar(matrix, points + i, results + i, count - i);
+    }
+
+    void multiply_neon(const mat4& lhs, const mat4* matrices, mat4* results, std::size_t count)
+    {
+        const float* l = floats(lhs);
+        float32x4_t l0 = vld1q_f32(l), l1 = vld1q_f32(l + 4), l2 = vld1q_f32(l + 8), l3 = vld1q_f32(l + 12);
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const float* r = floats(matrices[i]);
+            float* out = floats(results[i]);
+
+            for (int c = 0; c < 4; ++c)
+            {
+                float32x4_t col = vld1q_f32(r + c * 4);
+                float32x4_t result = vmulq_laneq_f32(l0, col, 0);
+                result = vfmaq_laneq_f32(result, l1, col, 1);
+                result = vfmaq_laneq_f32(result, l2, col, 2);
+                result = vfmaq_laneq_f32(result, l3, col, 3);
+                vst1q_f32(out + c * 4, result);
+            }
+        }
+    }
+
+    void intersect_neon(const plane* planes, std::size_t numPlanes, const sphere* spheres, uint8_t* results, std::size_t count)
+    {
+        std::size_t i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            float32x4x4_t s = vld4q_f32(floats(spheres[i]));
+            float32x4_t negativeRadius = vnegq_f32(s.val[3]);
+
+            uint32x4_t outside = vdupq_n_u32(0);
+            for (std::size_t p = 0; p < numPlanes; ++p)
+            {
+                auto& pl = planes[p];
+                float32x4_t d = vfmaq_n_f32(vfmaq_n_f32(vfmaq_n_f32(vdupq_n_f32(pl.p), s.val[2], pl.n.z), s.val[1], pl.n.y), s.val[0], pl.n.x);
+                outside = vorrq_u32(outside, vcltq_f32(d, negativeRadius));
+            }
+
+            results[i] = vgetq_lane_u32(outside, 0) ? 0 : 1;
+            results[i + 1] = vgetq_lane_u32(outside, 1) ? 0 : 1;
+            results[i + 2] = vgetq_lane_u32(outside, 2) ? 0 : 1;
+            results[i + 3] = vgetq_lane_u32(outside, 3) ? 0 : 1;
+        }
+
+        intersect_scalar(planes, numPlanes, spheres + i, results + i, count - i);
+    }
+
+    void cull_neon(const plane* planes, std::size_t numPlanes, const float* x, const float* y, const float* z, const float* radius, std::size_t first, std::size_t count, uint64_t* mask)
+    {
+        const uint32_t laneBits[4] = {1, 2, 4, 8};
+        uint32x4_t bits = vld1q_u32(laneBits);
+
+        std::size_t i = first;
+        for (; i + 4 <= count; i += 4)
+        {
+            float32x4_t sx = vld1q_f32(x + i), sy = vld1q_f32(y + i), sz = vld1q_f32(z + i);
+            float32x4_t negativeRadius = vnegq_f32(vld1q_f32(radius + i));
+
+            uint32x4_t inside = vdupq_n_u32(0xffffffff);
+            for (std::size_t p = 0; p < numPlanes && vmaxvq_u32(inside) != 0; ++p)
+            {
+                auto& pl = planes[p];
+                float32x4_t d = vfmaq_n_f32(vfmaq_n_f32(vfmaq_n_f32(vdupq_n_f32(pl.p), sz, pl.n.z), sy, pl.n.y), sx, pl.n.x);
+                inside = vandq_u32(inside, vcgeq_f32(d, negativeRadius));
+            }
+            setBits(mask, i, vaddvq_u32(vandq_u32(inside, bits)));
+        }
+
+        cull_scalar(planes, numPlanes, x, y, z, radius, i, count, mask);
+    }
+
+    const Kernels neonKernels{transform_neon, multiply_neon, intersect_neon, cull_neon};
+#endif
+
+    const Kernels& kernels(SimdLevel level)
+    {
+        switch (level)
+        {
+#ifdef BATCH_MATHS_X86
+        case SimdLevel::SSE: return sseKernels;
+        case SimdLevel::AVX2: return avx2Kernels;
+#endif
+#ifdef BATCH_MATHS_NEON
+        case SimdLevel::NEON: return neonKernels;
+#endif
+        default: return scalarKernels;
+        }
+    }
+
+    std::atomic<SimdLevel>& currentLevel()
+    {
+        static std::atomic<SimdLevel> s_level{detectSimdLevel()};
+        return s_level;
+    }
+
+    const Kernels& currentKernels()
+    {
+        return kernels(currentLevel().load(std::memory_order_relaxed));
+    }
+} // namespace
+
+const char* vsg::batch::name(SimdLevel level)
+{
+    switch (level)
+    {
+    case SimdLevel::SSE: return "SSE";
+    case SimdLevel::AVX2: return "AVX2";
+    case SimdLevel::NEON: return "NEON";
+    default: return "Scalar";
+    }
+}
+
+SimdLevel vsg::batch::detectSimdLevel()
+{
+#if defined(BATCH_MATHS_X86)
+    static const SimdLevel s_detected = cpuSupportsAVX2() ? SimdLevel::AVX2 : SimdLevel::SSE;
+    return s_detected;
+#elif defined(BATCH_MATHS_NEON)
+    return SimdLevel::NEON;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+bool vsg::batch::supported(SimdLevel level)
+{
+    switch (level)
+    {
+    case SimdLevel::Scalar: return true;
+#ifdef BATCH_MATHS_X86
+    case SimdLevel::SSE: return true;
+    case SimdLevel::AVX2: return detectSimdLevel() == SimdLevel::AVX2;
+#endif
+#ifdef BATCH_MATHS_NEON
+    case SimdLevel::NEON: return true;
+#endif
+    default: return false;
+    }
+}
+
+SimdLevel vsg::batch::getSimdLevel()
+{
+    return currentLevel().load();
+}
+
+void vsg::batch::setSimdLevel(SimdLevel level)
+{
+    if (supported(level)) currentLevel() = level;
+}
+
+void vsg::batch::transform(const mat4& matrix, const vec3* points, vec3* results, std::size_t count)
+{
+    currentKernels().transform(matrix, points, results, count);
+}
+
+void vsg::batch::multiply(const mat4& lhs, const mat4* matrices, mat4* results, std::size_t count)
+{
+    currentKernels().multiply(lhs, matrices, results, count);
+}
+
+void vsg::batch::intersect(const plane* planes, std::size_t numPlanes, const sphere* spheres, uint8_t* results, std::size_t count)
+{
+    currentKernels().intersect(planes, numPlanes, spheres, results, count);
+}
+
+std::size_t vsg::batch::cull(const plane* planes, std::size_t numPlanes, const Spheres& spheres, uint64_t* mask)
+{
+    std::size_t count = spheres.size();
+    std::memset(mask, 0, maskSize(count) * sizeof(uint64_t));
+
+    currentKernels().cull(planes, numPlanes, spheres.x.data(), spheres.y.data(), spheres.z.data(), spheres.radius.data(), 0, count, mask);
+
+    std::size_t numVisible = 0;
+    for (std::size_t w = 0; w < maskSize(count); ++w) numVisible += std::bitset<64>(mask[w]).count();
+    return numVisible;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <vsg/maths/vec3.h>
+#include <vsg/maths/mat4.h>
+#include <vsg/maths/plane.h>
+#include <vsg/maths/transform.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace vsg
+{
+    namespace batch
+    {
+
+        //
+        // Batched versions of the vsg maths operators for the hot CPU loops, transforming vertex arrays and culling instances.
+        // Each operation has a scalar kernel plus SSE, AVX2 and NEON kernels where the platform supports them, the kernel used
+        // is chosen at runtime from the instruction sets the CPU reports. Results match the scalar operators, the vec3 transform
+        // includes the perspective divide just as mat4 * vec3 does.
+        //
+
+        enum class SimdLevel
+        {
+            Scalar,
+            SSE,
+            AVX2,
+            NEON
+        };
+
+        const char* name(SimdLevel level);
+
+        // best SimdLevel supported by both the build and the CPU
+        SimdLevel detectSimdLevel();
+
+        // true if kernels for level are compiled in and the CPU can run them
+        bool supported(SimdLevel level);
+
+        // the level used by the batch functions, defaults to detectSimdLevel(), setSimdLevel() is ignored for unsupported levels.
+        SimdLevel getSimdLevel();
+        void setSimdLevel(SimdLevel level);
+
+        // results[i] = matrix * points[i], results may alias points.
+        void transform(const mat4& matrix, const vec3* points, vec3* results, std::size_t count);
+
+        // results[i] = lhs * matrices[i], results may alias matrices.
+        void multiply(const mat4& lhs, const mat4* matrices, mat4* results, std::size_t count);
+
+        // results[i] = intersect(planes, spheres[i]) ? 1 : 0, matching vsg::intersect(polytope, sphere).
+        void intersect(const plane* planes, std::size_t numPlanes, const sphere* spheres, uint8_t* results, std::size_t count);
+
+        // struct of arrays sphere centres and radii, so the cull kernels load whole SIMD registers without transposing.
+        struct Spheres
+        {
+            std::vector<float> x;
+            std::vector<float> y;
+            std::vector<float> z;
+            std::vector<float> radius;
+
+            std::size_t size() const { return x.size(); }
+
+            void reserve(std::size_t count)
+            {
+                x.reserve(count);
+                y.reserve(count);
+                z.reserve(count);
+                radius.reserve(count);
+            }
+
+            void push_back(const sphere& s)
+            {
+                x.push_back(s.center.x);
+                y.push_back(s.center.y);
+                z.push_back(s.center.z);
+                radius.push_back(s.radius);
+            }
+
+            void clear()
+            {
+                x.clear();
+                y.clear();
+                z.clear();
+                radius.clear();
+            }
+        };
+
+        // number of uint64_t words in the visibility mask for count spheres
+        inline std::size_t maskSize(std::size_t count) { return (count + 63) / 64; }
+
+        // bit i of mask is set if spheres i intersects the polytope, matching vsg::intersect(polytope, sphere).
+        // Each SIMD block of spheres stops testing planes once all its spheres are outside. mask must hold maskSize(spheres.size()) words.
+        // Returns the number of visible spheres.
+        std::size_t cull(const plane* planes, std::size_t numPlanes, const Spheres& spheres, uint64_t* mask);
+
+        inline bool visible(const uint64_t* mask, std::size_t i) { return (mask[i / 64] >> (i % 64)) & 1; }
+
+    } // namespace batch
+} // namespace vsg
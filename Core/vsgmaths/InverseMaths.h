@@ -0,0 +1,212 @@
+#pragma once
+
+#include <vsg/maths/mat4.h>
+#include <vsg/maths/transform.h>
+
+#include <limits>
+
+namespace vsg
+{
+
+    //
+    // Specialised inverses for the common classes of matrix, cheaper and more accurate than the general vsg::inverse().
+    // Apart from inverse_classified(), which may fall back to vsg::inverse(), the functions are constexpr so can be evaluated at compile time
+    // like vsg::translate() and vsg::scale(), to keep them usable in constant expressions elements are copied out through the public value
+    // members rather than the non constexpr operator[].
+    //
+
+    enum class MatrixClass
+    {
+        Rigid,       // orthonormal rotation + translation, inverse is the transposed rotation
+        Affine,      // any 3x3 + translation, bottom row 0,0,0,1
+        Perspective, // projection matrix of the form created by vsg::perspective()
+        General
+    };
+
+    namespace detail
+    {
+        template<typename T>
+        constexpr T absolute(T v) { return v < T(0) ? -v : v; }
+
+        template<typename T>
+        constexpr bool equivalent(T lhs, T rhs, T epsilon) { return absolute(lhs - rhs) <= epsilon; }
+
+        // detect whether the t_mat4 constructor takes its 16 values in row or column order, so results are always assembled correctly.
+        template<typename T>
+        constexpr bool constructorTakesRows()
+        {
+            return t_mat4<T>(0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0).value[1].value[0] == T(1);
+        }
+
+        // copy to a column major array, v[c][r]
+        template<typename T>
+        constexpr void copy(const t_mat4<T>& m, T (&v)[4][4])
+        {
+            for (int c = 0; c < 4; ++c)
+            {
+                for (int r = 0; r < 4; ++r) v[c][r] = m.value[c].value[r];
+            }
+        }
+
+        // m[c][r] as a column major array
+        template<typename T>
+        constexpr t_mat4<T> make_mat4(const T (&m)[4][4])
+        {
+            if constexpr (constructorTakesRows<T>())
+            {
+                return t_mat4<T>(m[0][0], m[1][0], m[2][0], m[3][0],
+                                 m[0][1], m[1][1], m[2][1], m[3][1],
+                                 m[0][2], m[1][2], m[2][2], m[3][2],
+                                 m[0][3], m[1][3], m[2][3], m[3][3]);
+            }
+            else
+            {
+                return t_mat4<T>(m[0][0], m[0][1], m[0][2], m[0][3],
+                                 m[1][0], m[1][1], m[1][2], m[1][3],
+                                 m[2][0], m[2][1], m[2][2], m[2][3],
+                                 m[3][0], m[3][1], m[3][2], m[3][3]);
+            }
+        }
+    } // namespace detail
+
+    template<typename T>
+    constexpr MatrixClass classify(const t_mat4<T>& m, T epsilon = T(1e-5))
+    {
+        using detail::equivalent;
+        T v[4][4] = {};
+        detail::copy(m, v);
+
+        bool bottomRowAffine = equivalent(v[0][3], T(0), epsilon) && equivalent(v[1][3], T(0), epsilon) && equivalent(v[2][3], T(0), epsilon) && equivalent(v[3][3], T(1), epsilon);
+        if (bottomRowAffine)
+        {
+            // columns of the 3x3 orthonormal, dot(ci, cj) == (i==j ? 1 : 0)
+            bool orthonormal = true;
+            for (int i = 0; i < 3 && orthonormal; ++i)
+            {
+                for (int j = i; j < 3 && orthonormal; ++j)
+                {
+                    T dot = v[i][0] * v[j][0] + v[i][1] * v[j][1] + v[i][2] * v[j][2];
+                    orthonormal = equivalent(dot, (i == j) ? T(1) : T(0), epsilon);
+                }
+            }
+            return orthonormal ? MatrixClass::Rigid : MatrixClass::Affine;
+        }
+
+        // perspective has non zero diagonal x & y, an optional off-centre shift in column 2, z & w rows coupled only through column 2 and 3
+        bool perspective = !equivalent(v[0][0], T(0), epsilon) && !equivalent(v[1][1], T(0), epsilon) && !equivalent(v[2][3], T(0), epsilon) && !equivalent(v[3][2], T(0), epsilon) &&
+                           equivalent(v[0][1], T(0), epsilon) && equivalent(v[0][2], T(0), epsilon) && equivalent(v[0][3], T(0), epsilon) &&
+                           equivalent(v[1][0], T(0), epsilon) && equivalent(v[1][2], T(0), epsilon) && equivalent(v[1][3], T(0), epsilon) &&
+                           equivalent(v[3][0], T(0), epsilon) && equivalent(v[3][1], T(0), epsilon) && equivalent(v[3][3], T(0), epsilon);
+
+        return perspective ? MatrixClass::Perspective : MatrixClass::General;
+    }
+
+    // inverse of an orthonormal rotation + translation
+    template<typename T>
+    constexpr t_mat4<T> inverse_rigid(const t_mat4<T>& m)
+    {
+        T v[4][4] = {};
+        detail::copy(m, v);
+        T r[4][4] = {};
+        for (int c = 0; c < 3; ++c)
+        {
+            for (int row = 0; row < 3; ++row) r[c][row] = v[row][c];
+        }
+        for (int row = 0; row < 3; ++row) r[3][row] = -(r[0][row] * v[3][0] + r[1][row] * v[3][1] + r[2][row] * v[3][2]);
+        r[3][3] = T(1);
+        return detail::make_mat4(r);
+    }
+
+    // inverse of a 3x3 + translation, the upper 3x3 is inverted by cofactors. Returns false, leaving inverse unchanged, if the 3x3 is singular.
+    template<typename T>
+    constexpr bool inverse_affine(const t_mat4<T>& m, t_mat4<T>& inverse)
+    {
+        T v[4][4] = {};
+        detail::copy(m, v);
+
+        T c00 = v[1][1] * v[2][2] - v[2][1] * v[1][2];
+        T c01 = v[2][1] * v[0][2] - v[0][1] * v[2][2];
+        T c02 = v[0][1] * v[1][2] - v[1][1] * v[0][2];
+
+        T det = v[0][0] * c00 + v[1][0] * c01 + v[2][0] * c02;
+        if (det == T(0)) return false;
+
+        T inv = T(1) / det;
+
+        T r[4][4] = {};
+        r[0][0] = c00 * inv;
+        r[0][1] = c01 * inv;
+        r[0][2] = c02 * inv;
+        r[1][0] = (v[2][0] * v[1][2] - v[1][0] * v[2][2]) * inv;
+        r[1][1] = (v[0][0] * v[2][2] - v[2][0] * v[0][2]) * inv;
+        r[1][2] = (v[1][0] * v[0][2] - v[0][0] * v[1][2]) * inv;
+        r[2][0] = (v[1][0] * v[2][1] - v[2][0] * v[1][1]) * inv;
+        r[2][1] = (v[2][0] * v[0][1] - v[0][0] * v[2][1]) * inv;
+        r[2][2] = (v[0][0] * v[1][1] - v[1][0] * v[0][1]) * inv;
+
+        for (int row = 0; row < 3; ++row) r[3][row] = -(r[0][row] * v[3][0] + r[1][row] * v[3][1] + r[2][row] * v[3][2]);
+        r[3][3] = T(1);
+        inverse = detail::make_mat4(r);
+        return true;
+    }
+
+    // inverse of a 3x3 + translation, a singular 3x3 returns a matrix of NaN so the failure propagates rather than passing as a valid inverse
+    template<typename T>
+    constexpr t_mat4<T> inverse_affine(const t_mat4<T>& m)
+    {
+        constexpr T nan = std::numeric_limits<T>::quiet_NaN();
+        t_mat4<T> inverse(nan, nan, nan, nan, nan, nan, nan, nan, nan, nan, nan, nan, nan, nan, nan, nan);
+        inverse_affine(m, inverse);
+        return inverse;
+    }
+
+    // inverse of a perspective projection, x' = a.x + c.z, y' = b.y + d.z, z' = e.z + f.w, w' = g.z
+    template<typename T>
+    constexpr t_mat4<T> inverse_perspective(const t_mat4<T>& m)
+    {
+        T v[4][4] = {};
+        detail::copy(m, v);
+        T a = v[0][0], b = v[1][1], c = v[2][0], d = v[2][1], e = v[2][2], f = v[3][2], g = v[2][3];
+
+        T r[4][4] = {};
+        r[0][0] = T(1) / a;
+        r[1][1] = T(1) / b;
+        r[2][3] = T(1) / f;
+        r[3][0] = -c / (a * g);
+        r[3][1] = -d / (b * g);
+        r[3][2] = T(1) / g;
+        r[3][3] = -e / (f * g);
+        return detail::make_mat4(r);
+    }
+
+    // classify the matrix and use the matching specialised inverse, falling back to vsg::inverse() for general and singular matrices.
+    // Not constexpr as vsg::inverse() isn't, use the specialised inverses directly in constant expressions.
+    template<typename T>
+    t_mat4<T> inverse_classified(const t_mat4<T>& m, T epsilon = T(1e-5))
+    {
+        switch (classify(m, epsilon))
+        {
+        case MatrixClass::Rigid: return inverse_rigid(m);
+        case MatrixClass::Affine:
+        {
+            t_mat4<T> result;
+            if (inverse_affine(m, result)) return result;
+            return inverse(m);
+        }
+        case MatrixClass::Perspective: return inverse_perspective(m);
+        default: return inverse(m);
+        }
+    }
+
+    inline const char* name(MatrixClass matrixClass)
+    {
+        switch (matrixClass)
+        {
+        case MatrixClass::Rigid: return "Rigid";
+        case MatrixClass::Affine: return "Affine";
+        case MatrixClass::Perspective: return "Perspective";
+        default: return "General";
+        }
+    }
+
+} // namespace vsg
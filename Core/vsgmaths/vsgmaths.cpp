@@ -13,15 +13,17 @@
 
 #include <vsg/io/stream.h>
 
+#include "BatchMaths.h"
+#include "InverseMaths.h"
+
 #include <iostream>
 #include <vector>
 #include <chrono>
 #include <cstddef>
 
 template<class M>
-bool test_inverse(const M& m)
+typename M::value_type identity_delta(const M& m, const M& im)
 {
-    auto im = vsg::inverse(m);
     auto m_mult_im = m * im;
     M identity;
     typename M::value_type delta = {};
@@ -32,11 +34,24 @@ bool test_inverse(const M& m)
             delta += std::abs(m_mult_im[c][r] - identity[c][r]);
         }
     }
+    return delta;
+}
+
+template<class M>
+bool test_inverse(const M& m)
+{
+    auto im = vsg::inverse(m);
+    auto m_mult_im = m * im;
     std::cout<<"\ntest_inverse()"<<std::endl;
     std::cout<<"matrix "<<m<<std::endl;
     std::cout<<"inverse "<<im<<std::endl;
     std::cout<<"m_mult_im "<<m_mult_im<<std::endl;
-    std::cout<<"delta "<<delta<<std::endl;
+    std::cout<<"delta "<<identity_delta(m, im)<<std::endl;
+
+    auto matrixClass = vsg::classify(m);
+    auto specialised_im = vsg::inverse_classified(m);
+    std::cout<<"classify "<<vsg::name(matrixClass)<<", inverse_classified "<<specialised_im<<std::endl;
+    std::cout<<"classified delta "<<identity_delta(m, specialised_im)<<std::endl;
     return true;
 }
 
@@ -100,6 +115,13 @@ int main(int /*argc*/, char** /*argv*/)
     constexpr vsg::mat4 scale = vsg::scale(vsg::vec3(1.0f, 2.0f, 3.0f));
     std::cout<<"scale = {"<<scale<<"}"<<std::endl;
 
+    // specialised inverses can be evaluated at compile time
+    constexpr vsg::mat4 inverse_trans = vsg::inverse_rigid(trans);
+    constexpr vsg::mat4 inverse_scale = vsg::inverse_affine(scale);
+    static_assert(vsg::classify(trans) == vsg::MatrixClass::Rigid, "translation is a rigid transform");
+    std::cout<<"inverse_trans = {"<<inverse_trans<<"}"<<std::endl;
+    std::cout<<"inverse_scale = {"<<inverse_scale<<"}"<<std::endl;
+
     // note VSG and OSG multiplication order reversed.
     vsg::mat4 result = scale*trans*rot;
     std::cout<<"result = {"<<result<<"}"<<std::endl;
@@ -214,6 +236,13 @@ int main(int /*argc*/, char** /*argv*/)
         std::cout<<std::endl;
     }
 
+    // batched intersection tests, using the best SIMD kernels the CPU supports
+    std::vector<uint8_t> batchResults(spheres.size());
+    vsg::batch::intersect(polytope.data(), polytope.size(), spheres.data(), batchResults.data(), spheres.size());
+    std::cout<<"batch::intersect() using "<<vsg::batch::name(vsg::batch::getSimdLevel())<<" : ";
+    for(auto result : batchResults) std::cout<<int(result)<<" ";
+    std::cout<<std::endl;
+
     vsg::vec3 pv(1.0, 2.0, 3.0);
     std::cout<<"pv * plane_trans = "<< (pv * plane_trans)<<std::endl;
     std::cout<<"plane_trans * pv = "<< (plane_trans * pv)<<std::endl;
@@ -224,6 +253,7 @@ int main(int /*argc*/, char** /*argv*/)
     test_inverse(rot_y);
     test_inverse(rot_z);
     test_inverse(plane_trans);
+    test_inverse(proj);
 
 
     return 0;
@@ -0,0 +1,210 @@
+#include <vsg/all.h>
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cmath>
+
+#include "BatchMaths.h"
+#include "InverseMaths.h"
+
+template<typename F>
+double time(unsigned int iterations, F function)
+{
+    // best of iterations, in milliseconds
+    double best = 0.0;
+    for(unsigned int i=0; i<iterations; ++i)
+    {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        double duration = std::chrono::duration<double, std::chrono::milliseconds::period>(std::chrono::steady_clock::now() - start).count();
+        if (i==0 || duration<best) best = duration;
+    }
+    return best;
+}
+
+void report(const char* name, std::size_t count, double scalarTime, double duration, double error, const char* errorName = "max error")
+{
+    std::cout<<"    "<<name<<"\t"<<duration<<"ms\t"<<double(count)/(duration*1000.0)<<" M/s\tspeedup "<<scalarTime/duration<<"\t"<<errorName<<" "<<error<<std::endl;
+}
+
+double maxIdentityDelta(const std::vector<vsg::dmat4>& matrices, const std::vector<vsg::dmat4>& inverses)
+{
+    double maxDelta = 0.0;
+    for(std::size_t i=0; i<matrices.size(); ++i)
+    {
+        auto m_mult_im = matrices[i] * inverses[i];
+        double delta = 0.0;
+        for(std::size_t c=0; c<4; ++c)
+        {
+            for(std::size_t r=0; r<4; ++r) delta += std::abs(m_mult_im[c][r] - (c==r ? 1.0 : 0.0));
+        }
+        maxDelta = std::max(maxDelta, delta);
+    }
+    return maxDelta;
+}
+
+template<class F>
+void benchmarkInverse(const char* className, unsigned int iterations, const std::vector<vsg::dmat4>& matrices, F specialised)
+{
+    std::size_t count = matrices.size();
+    std::vector<vsg::dmat4> inverses(count);
+
+    std::cout<<"\ninverse "<<count<<" "<<className<<" dmat4, classified as "<<vsg::name(vsg::classify(matrices.front()))<<std::endl;
+
+    double generalTime = time(iterations, [&]() { for(std::size_t i=0; i<count; ++i) inverses[i] = vsg::inverse(matrices[i]); });
+    report("inverse", count, generalTime, generalTime, maxIdentityDelta(matrices, inverses));
+
+    double specialisedTime = time(iterations, [&]() { for(std::size_t i=0; i<count; ++i) inverses[i] = specialised(matrices[i]); });
+    report("specialised", count, generalTime, specialisedTime, maxIdentityDelta(matrices, inverses));
+
+    double classifiedTime = time(iterations, [&]() { for(std::size_t i=0; i<count; ++i) inverses[i] = vsg::inverse_classified(matrices[i]); });
+    report("classified", count, generalTime, classifiedTime, maxIdentityDelta(matrices, inverses));
+}
+
+std::vector<vsg::batch::SimdLevel> supportedLevels()
+{
+    std::vector<vsg::batch::SimdLevel> levels;
+    for(auto level : {vsg::batch::SimdLevel::Scalar, vsg::batch::SimdLevel::SSE, vsg::batch::SimdLevel::AVX2, vsg::batch::SimdLevel::NEON})
+    {
+        if (vsg::batch::supported(level)) levels.push_back(level);
+    }
+    return levels;
+}
+
+int main(int argc, char** argv)
+{
+    vsg::CommandLine arguments(&argc, argv);
+    auto numPoints = arguments.value<std::size_t>(1000000, {"-p", "--points"});
+    auto numMatrices = arguments.value<std::size_t>(100000, {"-m", "--matrices"});
+    auto numSpheres = arguments.value<std::size_t>(1000000, {"-s", "--spheres"});
+    auto iterations = arguments.value(10u, {"-i", "--iterations"});
+    if (arguments.errors()) return arguments.writeErrorMessages(std::cerr);
+
+    std::mt19937 generator(0);
+    std::uniform_real_distribution<float> random(-100.0f, 100.0f);
+
+    auto matrix = vsg::perspective(vsg::radians(45.0f), 1.5f, 0.1f, 1000.0f) * vsg::lookAt(vsg::vec3(200.0f, -300.0f, 150.0f), vsg::vec3(0.0f, 0.0f, 0.0f), vsg::vec3(0.0f, 0.0f, 1.0f));
+
+    std::vector<vsg::vec3> points(numPoints);
+    for(auto& point : points) point.set(random(generator), random(generator), random(generator));
+
+    std::vector<vsg::mat4> matrices(numMatrices);
+    for(auto& m : matrices) m = vsg::translate(random(generator), random(generator), random(generator)) * vsg::rotate(vsg::radians(random(generator)), 0.0f, 0.0f, 1.0f);
+
+    std::vector<vsg::sphere> spheres(numSpheres);
+    for(auto& s : spheres) s = vsg::sphere(vsg::vec3(random(generator), random(generator), random(generator)), std::abs(random(generator))*0.1f);
+
+    // view frustum style polytope
+    std::vector<vsg::plane> polytope{
+        vsg::plane(1.0, 0.0, 0.0, 50.0),
+        vsg::plane(-1.0, 0.0, 0.0, 50.0),
+        vsg::plane(0.0, 1.0, 0.0, 50.0),
+        vsg::plane(0.0, -1.0, 0.0, 50.0),
+        vsg::plane(0.0, 0.0, 1.0, 80.0),
+        vsg::plane(0.0, 0.0, -1.0, 80.0)
+    };
+
+    std::cout<<"vsgmathsbenchmark detected SIMD level "<<vsg::batch::name(vsg::batch::detectSimdLevel())<<", best of "<<iterations<<" iterations"<<std::endl;
+
+    {
+        std::vector<vsg::vec3> reference(numPoints), results(numPoints);
+        double scalarTime = time(iterations, [&]() { for(std::size_t i=0; i<numPoints; ++i) reference[i] = matrix * points[i]; });
+
+        std::cout<<"\ntransform "<<numPoints<<" vec3 by mat4"<<std::endl;
+        report("operator*", numPoints, scalarTime, scalarTime, 0.0);
+        for(auto level : supportedLevels())
+        {
+            vsg::batch::setSimdLevel(level);
+            double duration = time(iterations, [&]() { vsg::batch::transform(matrix, points.data(), results.data(), numPoints); });
+
+            double maxError = 0.0;
+            for(std::size_t i=0; i<numPoints; ++i) maxError = std::max(maxError, double(vsg::length(results[i] - reference[i])));
+            report(vsg::batch::name(level), numPoints, scalarTime, duration, maxError);
+        }
+    }
+
+    {
+        std::vector<vsg::mat4> reference(numMatrices), results(numMatrices);
+        double scalarTime = time(iterations, [&]() { for(std::size_t i=0; i<numMatrices; ++i) reference[i] = matrix * matrices[i]; });
+
+        std::cout<<"\nmultiply "<<numMatrices<<" mat4 by mat4"<<std::endl;
+        report("operator*", numMatrices, scalarTime, scalarTime, 0.0);
+        for(auto level : supportedLevels())
+        {
+            vsg::batch::setSimdLevel(level);
+            double duration = time(iterations, [&]() { vsg::batch::multiply(matrix, matrices.data(), results.data(), numMatrices); });
+
+            double maxError = 0.0;
+            for(std::size_t i=0; i<numMatrices; ++i)
+            {
+                for(std::size_t c=0; c<4; ++c)
+                {
+                    for(std::size_t r=0; r<4; ++r) maxError = std::max(maxError, double(std::abs(results[i][c][r] - reference[i][c][r])));
+                }
+            }
+            report(vsg::batch::name(level), numMatrices, scalarTime, duration, maxError);
+        }
+    }
+
+    {
+        std::vector<uint8_t> reference(numSpheres), results(numSpheres);
+        double scalarTime = time(iterations, [&]() { for(std::size_t i=0; i<numSpheres; ++i) reference[i] = vsg::intersect(polytope, spheres[i]) ? 1 : 0; });
+
+        std::size_t numVisible = 0;
+        for(auto visible : reference) numVisible += visible;
+
+        std::cout<<"\nintersect "<<numSpheres<<" spheres with "<<polytope.size()<<" plane polytope, "<<numVisible<<" visible"<<std::endl;
+        report("intersect", numSpheres, scalarTime, scalarTime, 0.0, "mismatches");
+        for(auto level : supportedLevels())
+        {
+            vsg::batch::setSimdLevel(level);
+            double duration = time(iterations, [&]() { vsg::batch::intersect(polytope.data(), polytope.size(), spheres.data(), results.data(), numSpheres); });
+
+            std::size_t mismatches = 0;
+            for(std::size_t i=0; i<numSpheres; ++i) if (results[i] != reference[i]) ++mismatches;
+            report(vsg::batch::name(level), numSpheres, scalarTime, duration, double(mismatches), "mismatches");
+        }
+    }
+
+    {
+        vsg::batch::Spheres soaSpheres;
+        soaSpheres.reserve(numSpheres);
+        for(auto& s : spheres) soaSpheres.push_back(s);
+
+        std::vector<uint8_t> reference(numSpheres);
+        double scalarTime = time(iterations, [&]() { for(std::size_t i=0; i<numSpheres; ++i) reference[i] = vsg::intersect(polytope, spheres[i]) ? 1 : 0; });
+
+        std::cout<<"\ncull "<<numSpheres<<" struct of arrays spheres to visibility mask"<<std::endl;
+        report("intersect", numSpheres, scalarTime, scalarTime, 0.0, "mismatches");
+
+        std::vector<uint64_t> mask(vsg::batch::maskSize(numSpheres));
+        for(auto level : supportedLevels())
+        {
+            vsg::batch::setSimdLevel(level);
+            double duration = time(iterations, [&]() { vsg::batch::cull(polytope.data(), polytope.size(), soaSpheres, mask.data()); });
+
+            std::size_t mismatches = 0;
+            for(std::size_t i=0; i<numSpheres; ++i) if (vsg::batch::visible(mask.data(), i) != (reference[i] != 0)) ++mismatches;
+            report(vsg::batch::name(level), numSpheres, scalarTime, duration, double(mismatches), "mismatches");
+        }
+    }
+
+    {
+        std::uniform_real_distribution<double> angle(0.0, vsg::radians(360.0));
+        std::uniform_real_distribution<double> scale(0.1, 10.0);
+        std::uniform_real_distribution<double> fov(vsg::radians(20.0), vsg::radians(90.0));
+
+        std::vector<vsg::dmat4> rigid(numMatrices), affine(numMatrices), perspective(numMatrices);
+        for(auto& m : rigid) m = vsg::translate(double(random(generator)), double(random(generator)), double(random(generator))) * vsg::rotate(angle(generator), 0.0, 0.0, 1.0) * vsg::rotate(angle(generator), 1.0, 0.0, 0.0);
+        for(auto& m : affine) m = vsg::translate(double(random(generator)), double(random(generator)), double(random(generator))) * vsg::rotate(angle(generator), 0.0, 0.0, 1.0) * vsg::scale(scale(generator), scale(generator), scale(generator));
+        for(auto& m : perspective) m = vsg::perspective(fov(generator), scale(generator), 0.1, 1000.0*scale(generator));
+
+        benchmarkInverse("rigid", iterations, rigid, [](const vsg::dmat4& m) { return vsg::inverse_rigid(m); });
+        benchmarkInverse("affine", iterations, affine, [](const vsg::dmat4& m) { return vsg::inverse_affine(m); });
+        benchmarkInverse("perspective", iterations, perspective, [](const vsg::dmat4& m) { return vsg::inverse_perspective(m); });
+    }
+
+    return 0;
+}
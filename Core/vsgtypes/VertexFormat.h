@@ -0,0 +1,207 @@
+#pragma once
+
+#include <vsg/maths/vec2.h>
+#include <vsg/maths/vec3.h>
+#include <vsg/maths/vec4.h>
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace vsg
+{
+
+    //
+    // Compile time mapping from scalar and t_vec2/3/4 types to VkFormat, and generators for the vertex input binding and
+    // attribute descriptions of vertex arrays and interleaved vertex structs, so pipeline setup needs no hand written
+    // format tables or runtime type lookups.
+    //
+
+    // component type and count of the types that map to a VkFormat
+    template<typename T>
+    struct vertex_type_traits
+    {
+        using component_type = T;
+        static constexpr std::size_t num_components = 1;
+    };
+
+    template<typename T>
+    struct vertex_type_traits<t_vec2<T>>
+    {
+        using component_type = T;
+        static constexpr std::size_t num_components = 2;
+    };
+
+    template<typename T>
+    struct vertex_type_traits<t_vec3<T>>
+    {
+        using component_type = T;
+        static constexpr std::size_t num_components = 3;
+    };
+
+    template<typename T>
+    struct vertex_type_traits<t_vec4<T>>
+    {
+        using component_type = T;
+        static constexpr std::size_t num_components = 4;
+    };
+
+    namespace detail
+    {
+        // VkFormat for numComponents of type T, VK_FORMAT_UNDEFINED if there is no matching format
+        template<typename T>
+        constexpr VkFormat componentFormat(std::size_t numComponents)
+        {
+            if (numComponents < 1 || numComponents > 4) return VK_FORMAT_UNDEFINED;
+            std::size_t i = numComponents - 1;
+
+            if constexpr (std::is_same_v<T, float>)
+            {
+                constexpr VkFormat formats[] = {VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT};
+                return formats[i];
+            }
+            else if constexpr (std::is_same_v<T, double>)
+            {
+                constexpr VkFormat formats[] = {VK_FORMAT_R64_SFLOAT, VK_FORMAT_R64G64_SFLOAT, VK_FORMAT_R64G64B64_SFLOAT, VK_FORMAT_R64G64B64A64_SFLOAT};
+                return formats[i];
+            }
+            else if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>)
+            {
+                // integer formats chosen by size and signedness, so char, short, int, long and long long all map on every platform.
+                // Plain char is always SINT whatever the platform's char signedness, as the vsgtypes VkFormat table has always mapped it.
+                constexpr bool isSigned = std::is_signed_v<T> || std::is_same_v<T, char>;
+                if constexpr (sizeof(T) == 1)
+                {
+                    constexpr VkFormat formats[] = {VK_FORMAT_R8_UINT, VK_FORMAT_R8G8_UINT, VK_FORMAT_R8G8B8_UINT, VK_FORMAT_R8G8B8A8_UINT};
+                    constexpr VkFormat signedFormats[] = {VK_FORMAT_R8_SINT, VK_FORMAT_R8G8_SINT, VK_FORMAT_R8G8B8_SINT, VK_FORMAT_R8G8B8A8_SINT};
+                    return isSigned ? signedFormats[i] : formats[i];
+                }
+                else if constexpr (sizeof(T) == 2)
+                {
+                    constexpr VkFormat formats[] = {VK_FORMAT_R16_UINT, VK_FORMAT_R16G16_UINT, VK_FORMAT_R16G16B16_UINT, VK_FORMAT_R16G16B16A16_UINT};
+                    constexpr VkFormat signedFormats[] = {VK_FORMAT_R16_SINT, VK_FORMAT_R16G16_SINT, VK_FORMAT_R16G16B16_SINT, VK_FORMAT_R16G16B16A16_SINT};
+                    return isSigned ? signedFormats[i] : formats[i];
+                }
+                else if constexpr (sizeof(T) == 4)
+                {
+                    constexpr VkFormat formats[] = {VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32A32_UINT};
+                    constexpr VkFormat signedFormats[] = {VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT};
+                    return isSigned ? signedFormats[i] : formats[i];
+                }
+                else if constexpr (sizeof(T) == 8)
+                {
+                    constexpr VkFormat formats[] = {VK_FORMAT_R64_UINT, VK_FORMAT_R64G64_UINT, VK_FORMAT_R64G64B64_UINT, VK_FORMAT_R64G64B64A64_UINT};
+                    constexpr VkFormat signedFormats[] = {VK_FORMAT_R64_SINT, VK_FORMAT_R64G64_SINT, VK_FORMAT_R64G64B64_SINT, VK_FORMAT_R64G64B64A64_SINT};
+                    return isSigned ? signedFormats[i] : formats[i];
+                }
+                else
+                {
+                    return VK_FORMAT_UNDEFINED;
+                }
+            }
+            else
+            {
+                return VK_FORMAT_UNDEFINED;
+            }
+        }
+    } // namespace detail
+
+    // VkFormat of T, VK_FORMAT_UNDEFINED for types with no matching format
+    template<typename T>
+    constexpr VkFormat vk_format_v = detail::componentFormat<typename vertex_type_traits<T>::component_type>(vertex_type_traits<T>::num_components);
+
+    template<typename T>
+    constexpr VkFormat vk_format() { return vk_format_v<T>; }
+
+    template<typename T>
+    constexpr VkFormat vk_format(const T&) { return vk_format_v<T>; }
+
+    // vertex shader input locations used by T, 64 bit vectors of 3 or 4 components take two
+    template<typename T>
+    constexpr uint32_t vk_locations_v = (sizeof(typename vertex_type_traits<T>::component_type) == 8 && vertex_type_traits<T>::num_components > 2) ? 2 : 1;
+
+    //
+    // VertexArrays<T...> describes one vertex array per binding, binding i holding an array of the i'th type read at location i onwards.
+    //
+    //     using VertexInputs = vsg::VertexArrays<vsg::vec3, vsg::vec3, vsg::vec2>; // vertex, colour and tex coord arrays
+    //     auto vertexInputState = vsg::VertexInputState::create(VertexInputs::bindingDescriptions(), VertexInputs::attributeDescriptions());
+    //
+    template<typename... T>
+    struct VertexArrays
+    {
+        static constexpr std::size_t size = sizeof...(T);
+
+        static_assert(((vk_format_v<T> != VK_FORMAT_UNDEFINED) && ...), "VertexArrays type has no matching VkFormat");
+
+        static constexpr std::array<uint32_t, size> strides{{static_cast<uint32_t>(sizeof(T))...}};
+        static constexpr std::array<VkFormat, size> formats{{vk_format_v<T>...}};
+        static constexpr std::array<uint32_t, size> locations{{vk_locations_v<T>...}};
+
+        // binding i has the stride of the i'th type
+        static constexpr std::array<VkVertexInputBindingDescription, size> bindings(VkVertexInputRate inputRate = VK_VERTEX_INPUT_RATE_VERTEX)
+        {
+            std::array<VkVertexInputBindingDescription, size> descriptions{};
+            for (uint32_t i = 0; i < size; ++i) descriptions[i] = VkVertexInputBindingDescription{i, strides[i], inputRate};
+            return descriptions;
+        }
+
+        // attribute i reads binding i from offset 0, locations are consecutive
+        static constexpr std::array<VkVertexInputAttributeDescription, size> attributes()
+        {
+            std::array<VkVertexInputAttributeDescription, size> descriptions{};
+            uint32_t location = 0;
+            for (uint32_t i = 0; i < size; ++i)
+            {
+                descriptions[i] = VkVertexInputAttributeDescription{location, i, formats[i], 0};
+                location += locations[i];
+            }
+            return descriptions;
+        }
+
+        static std::vector<VkVertexInputBindingDescription> bindingDescriptions(VkVertexInputRate inputRate = VK_VERTEX_INPUT_RATE_VERTEX)
+        {
+            auto descriptions = bindings(inputRate);
+            return std::vector<VkVertexInputBindingDescription>(descriptions.begin(), descriptions.end());
+        }
+
+        static std::vector<VkVertexInputAttributeDescription> attributeDescriptions()
+        {
+            auto descriptions = attributes();
+            return std::vector<VkVertexInputAttributeDescription>(descriptions.begin(), descriptions.end());
+        }
+    };
+
+    //
+    // Attribute descriptions for an interleaved vertex struct, the members listed with VSG_VERTEX_MEMBER.
+    //
+    //     struct Vertex { vsg::vec3 position; vsg::vec3 normal; vsg::vec2 texCoord; };
+    //     constexpr auto attributes = vsg::vertexAttributes(0, {VSG_VERTEX_MEMBER(Vertex, position), VSG_VERTEX_MEMBER(Vertex, normal), VSG_VERTEX_MEMBER(Vertex, texCoord)});
+    //     VkVertexInputBindingDescription binding{0, sizeof(Vertex), VK_VERTEX_INPUT_RATE_VERTEX};
+    //
+    struct VertexMember
+    {
+        VkFormat format;
+        uint32_t offset;
+        uint32_t locations;
+    };
+
+#define VSG_VERTEX_MEMBER(Vertex, member) vsg::VertexMember{vsg::vk_format_v<decltype(Vertex::member)>, static_cast<uint32_t>(offsetof(Vertex, member)), vsg::vk_locations_v<decltype(Vertex::member)>}
+
+    template<std::size_t N>
+    constexpr std::array<VkVertexInputAttributeDescription, N> vertexAttributes(uint32_t binding, const VertexMember (&members)[N], uint32_t firstLocation = 0)
+    {
+        std::array<VkVertexInputAttributeDescription, N> descriptions{};
+        uint32_t location = firstLocation;
+        for (std::size_t i = 0; i < N; ++i)
+        {
+            descriptions[i] = VkVertexInputAttributeDescription{location, binding, members[i].format, members[i].offset};
+            location += members[i].locations;
+        }
+        return descriptions;
+    }
+
+} // namespace vsg
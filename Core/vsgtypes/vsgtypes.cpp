@@ -18,10 +18,10 @@
 #include <chrono>
 #include <cstddef>
 #include <typeinfo>
-#include <typeindex>
-#include <unordered_map>
 #include <type_traits>
 
+#include "VertexFormat.h"
+
 
 namespace vsg
 {
@@ -54,19 +54,36 @@ namespace vsg
     using uivec4 = t_vec4<unsigned int>;
 }
 
-std::unordered_map<std::type_index, VkFormat> VkFormatTypeMap;
-
-template<typename T>
-VkFormat VkFormatForType(T)
+// the VkFormat of each type is resolved at compile time
+static_assert(vsg::vk_format_v<unsigned char> == VK_FORMAT_R8_UINT, "unsigned char format");
+static_assert(vsg::vk_format_v<signed char> == VK_FORMAT_R8_SINT, "signed char format");
+static_assert(vsg::vk_format_v<char> == VK_FORMAT_R8_SINT, "char format");
+static_assert(vsg::vk_format_v<short> == VK_FORMAT_R16_SINT, "short format");
+static_assert(vsg::vk_format_v<unsigned int> == VK_FORMAT_R32_UINT, "unsigned int format");
+static_assert(vsg::vk_format_v<int> == VK_FORMAT_R32_SINT, "int format");
+static_assert(vsg::vk_format_v<uint64_t> == VK_FORMAT_R64_UINT, "uint64_t format");
+static_assert(vsg::vk_format_v<int64_t> == VK_FORMAT_R64_SINT, "int64_t format");
+static_assert(vsg::vk_format_v<float> == VK_FORMAT_R32_SFLOAT, "float format");
+static_assert(vsg::vk_format_v<double> == VK_FORMAT_R64_SFLOAT, "double format");
+static_assert(vsg::vk_format_v<vsg::vec2> == VK_FORMAT_R32G32_SFLOAT, "vec2 format");
+static_assert(vsg::vk_format_v<vsg::dvec3> == VK_FORMAT_R64G64B64_SFLOAT, "dvec3 format");
+static_assert(vsg::vk_format_v<vsg::ivec3> == VK_FORMAT_R32G32B32_SINT, "ivec3 format");
+static_assert(vsg::vk_format_v<vsg::uivec4> == VK_FORMAT_R32G32B32A32_UINT, "uivec4 format");
+static_assert(vsg::vk_format_v<vsg::ucvec4> == VK_FORMAT_R8G8B8A8_UINT, "ucvec4 format");
+static_assert(vsg::vk_format_v<vsg::usvec2> == VK_FORMAT_R16G16_UINT, "usvec2 format");
+static_assert(vsg::vk_format_v<vsg::mat4> == VK_FORMAT_UNDEFINED, "mat4 has no vertex format");
+
+// interleaved vertex, its attribute descriptions generated at compile time
+struct Vertex
 {
-    return VkFormatTypeMap[std::type_index(typeid(T))];
-}
+    vsg::vec3 position;
+    vsg::vec3 normal;
+    vsg::vec2 texCoord;
+    vsg::ucvec4 colour;
+};
 
-template<typename T>
-VkFormat VkFormatForType()
-{
-    return VkFormatTypeMap[std::type_index(typeid(T))];
-}
+constexpr auto vertexAttributes = vsg::vertexAttributes(0, {VSG_VERTEX_MEMBER(Vertex, position), VSG_VERTEX_MEMBER(Vertex, normal), VSG_VERTEX_MEMBER(Vertex, texCoord), VSG_VERTEX_MEMBER(Vertex, colour)});
+static_assert(vertexAttributes[2].location == 2 && vertexAttributes[2].format == VK_FORMAT_R32G32_SFLOAT && vertexAttributes[2].offset == offsetof(Vertex, texCoord), "texCoord attribute");
 
 int main(int /*argc*/, char** /*argv*/)
 {
@@ -85,47 +102,34 @@ int main(int /*argc*/, char** /*argv*/)
 
 
 
-    VkFormatTypeMap[std::type_index(typeid(unsigned char))] =   VK_FORMAT_R8_UINT;
-    VkFormatTypeMap[std::type_index(typeid(char))] =            VK_FORMAT_R8_SINT;
-    VkFormatTypeMap[std::type_index(typeid(short))] =           VK_FORMAT_R16_SINT;
-    VkFormatTypeMap[std::type_index(typeid(unsigned int))] =    VK_FORMAT_R32_UINT;
-    VkFormatTypeMap[std::type_index(typeid(int))] =             VK_FORMAT_R32_SINT;
-    VkFormatTypeMap[std::type_index(typeid(unsigned long))] =   VK_FORMAT_R64_UINT;
-    VkFormatTypeMap[std::type_index(typeid(long))] =            VK_FORMAT_R64_SINT;
-    VkFormatTypeMap[std::type_index(typeid(float))] =           VK_FORMAT_R32_SFLOAT;
-    VkFormatTypeMap[std::type_index(typeid(double))] =          VK_FORMAT_R64_SFLOAT;
-
-    VkFormatTypeMap[std::type_index(typeid(vsg::vec2))] =       VK_FORMAT_R32G32_SFLOAT;
-    VkFormatTypeMap[std::type_index(typeid(vsg::dvec2))] =      VK_FORMAT_R64G64_SFLOAT;
-    VkFormatTypeMap[std::type_index(typeid(vsg::uivec2))] =     VK_FORMAT_R32G32_UINT;
-    VkFormatTypeMap[std::type_index(typeid(vsg::ivec2))] =      VK_FORMAT_R32G32_SINT;
-
-    VkFormatTypeMap[std::type_index(typeid(vsg::vec3))] =       VK_FORMAT_R32G32B32_SFLOAT;
-    VkFormatTypeMap[std::type_index(typeid(vsg::dvec3))] =      VK_FORMAT_R64G64B64_SFLOAT;
-    VkFormatTypeMap[std::type_index(typeid(vsg::uivec3))] =     VK_FORMAT_R32G32B32_UINT;
-    VkFormatTypeMap[std::type_index(typeid(vsg::ivec3))] =      VK_FORMAT_R32G32B32_SINT;
-
-    VkFormatTypeMap[std::type_index(typeid(vsg::vec4))] =       VK_FORMAT_R32G32B32A32_SFLOAT;
-    VkFormatTypeMap[std::type_index(typeid(vsg::dvec4))] =      VK_FORMAT_R64G64B64A64_SFLOAT;
-    VkFormatTypeMap[std::type_index(typeid(vsg::uivec4))] =     VK_FORMAT_R32G32B32A32_UINT;
-    VkFormatTypeMap[std::type_index(typeid(vsg::ivec4))] =      VK_FORMAT_R32G32B32A32_SINT;
-    VkFormatTypeMap[std::type_index(typeid(vsg::ucvec4))] =     VK_FORMAT_R8G8B8A8_UINT;
-
-    std::cout<<"VkFormat "<<VkFormatForType('c')<<std::endl;
-    std::cout<<"VkFormat "<<VkFormatForType<unsigned char>()<<std::endl;
-    std::cout<<"VkFormat "<<VkFormatForType<float>()<<std::endl;
-    std::cout<<"VkFormat "<<VkFormatForType(1)<<std::endl;
-    std::cout<<"VkFormat "<<VkFormatForType(1l)<<std::endl;
-    std::cout<<"VkFormat "<<VkFormatForType(1.0f)<<std::endl;
-    std::cout<<"VkFormat "<<VkFormatForType(1.0)<<std::endl;
-    std::cout<<"VkFormat "<<VkFormatForType(vsg::vec2(1.0f, 2.4f))<<std::endl;
-    std::cout<<"VkFormat "<<VkFormatForType(vsg::dvec2(1.0, 2.4))<<std::endl;
-    std::cout<<"VkFormat "<<VkFormatForType(vsg::vec3(1.0f, 2.4f, 0.3f))<<std::endl;
-    std::cout<<"VkFormat "<<VkFormatForType(vsg::dvec3(1.0, 2.4, 0.2))<<std::endl;
-    std::cout<<"VkFormat "<<VkFormatForType(vsg::vec4(1.0f, 2.4f, 0.1f, 0.2f))<<std::endl;
-    std::cout<<"VkFormat "<<VkFormatForType(vsg::dvec4(1.0, 2.4, 0.1, 0.2))<<std::endl;
-    std::cout<<"VkFormat "<<VkFormatForType(vsg::uivec4(1, 2, 0, 0))<<std::endl;
-    std::cout<<"VkFormat "<<VkFormatForType(vsg::ucvec4(1, 2, 0, 0))<<std::endl;
+    std::cout<<"VkFormat "<<vsg::vk_format('c')<<std::endl;
+    std::cout<<"VkFormat "<<vsg::vk_format<unsigned char>()<<std::endl;
+    std::cout<<"VkFormat "<<vsg::vk_format<float>()<<std::endl;
+    std::cout<<"VkFormat "<<vsg::vk_format(1)<<std::endl;
+    std::cout<<"VkFormat "<<vsg::vk_format(1l)<<std::endl;
+    std::cout<<"VkFormat "<<vsg::vk_format(1.0f)<<std::endl;
+    std::cout<<"VkFormat "<<vsg::vk_format(1.0)<<std::endl;
+    std::cout<<"VkFormat "<<vsg::vk_format(vsg::vec2(1.0f, 2.4f))<<std::endl;
+    std::cout<<"VkFormat "<<vsg::vk_format(vsg::dvec2(1.0, 2.4))<<std::endl;
+    std::cout<<"VkFormat "<<vsg::vk_format(vsg::vec3(1.0f, 2.4f, 0.3f))<<std::endl;
+    std::cout<<"VkFormat "<<vsg::vk_format(vsg::dvec3(1.0, 2.4, 0.2))<<std::endl;
+    std::cout<<"VkFormat "<<vsg::vk_format(vsg::vec4(1.0f, 2.4f, 0.1f, 0.2f))<<std::endl;
+    std::cout<<"VkFormat "<<vsg::vk_format(vsg::dvec4(1.0, 2.4, 0.1, 0.2))<<std::endl;
+    std::cout<<"VkFormat "<<vsg::vk_format(vsg::uivec4(1, 2, 0, 0))<<std::endl;
+    std::cout<<"VkFormat "<<vsg::vk_format(vsg::ucvec4(1, 2, 0, 0))<<std::endl;
+
+    std::cout<<"Vertex attributes, stride "<<sizeof(Vertex)<<std::endl;
+    for(auto& attribute : vertexAttributes)
+    {
+        std::cout<<"    location "<<attribute.location<<", binding "<<attribute.binding<<", format "<<attribute.format<<", offset "<<attribute.offset<<std::endl;
+    }
+
+    using VertexInputs = vsg::VertexArrays<vsg::vec3, vsg::vec3, vsg::vec2, vsg::dvec4>;
+    std::cout<<"VertexArrays attributes"<<std::endl;
+    for(auto& attribute : VertexInputs::attributes())
+    {
+        std::cout<<"    location "<<attribute.location<<", binding "<<attribute.binding<<", format "<<attribute.format<<", offset "<<attribute.offset<<std::endl;
+    }
 
     constexpr float x = 180.0f;
     constexpr float rad1 = vsg::radians(90.0f);
@@ -0,0 +1,125 @@
+#include "FlatUserValues.h"
+
+#include <algorithm>
+#include <atomic>
+
+using namespace vsg;
+
+namespace
+{
+    struct KeyLess
+    {
+        bool operator()(const FlatUserValues::Entry& entry, FlatUserValues::Id id) const { return entry.key < id; }
+    };
+
+    std::atomic<std::size_t> s_numAllocations{0};
+}
+
+std::size_t FlatUserValues::numAllocations()
+{
+    return s_numAllocations.load(std::memory_order_relaxed);
+}
+
+void FlatUserValues::countAllocation()
+{
+    s_numAllocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+FlatUserValues::FlatUserValues(const FlatUserValues& rhs) :
+    _entries(rhs._entries)
+{
+    for (auto& entry : _entries)
+    {
+        if (entry.type == Type::Object) entry.object->ref();
+    }
+}
+
+FlatUserValues& FlatUserValues::operator=(const FlatUserValues& rhs)
+{
+    if (&rhs == this) return *this;
+
+    // ref the new objects before releasing the old in case they are shared
+    for (auto& entry : rhs._entries)
+    {
+        if (entry.type == Type::Object) entry.object->ref();
+    }
+    clear();
+    _entries = rhs._entries;
+    return *this;
+}
+
+FlatUserValues& FlatUserValues::operator=(FlatUserValues&& rhs) noexcept
+{
+    if (&rhs == this) return *this;
+
+    clear();
+    _entries = std::move(rhs._entries);
+    return *this;
+}
+
+const FlatUserValues::Entry* FlatUserValues::find(Id id) const
+{
+    auto itr = std::lower_bound(_entries.begin(), _entries.end(), id, KeyLess());
+    return (itr != _entries.end() && itr->key == id) ? &(*itr) : nullptr;
+}
+
+FlatUserValues::Entry& FlatUserValues::assign(Id id, Type type)
+{
+    auto itr = std::lower_bound(_entries.begin(), _entries.end(), id, KeyLess());
+    if (itr != _entries.end() && itr->key == id)
+    {
+        release(*itr);
+    }
+    else
+    {
+        // the vector grows geometrically so attaching n values costs O(log n) allocations, call shrink_to_fit() once set up to release the spare capacity
+        if (_entries.size() == _entries.capacity()) countAllocation();
+        itr = _entries.insert(itr, Entry());
+        itr->key = id;
+    }
+
+    itr->type = type;
+    itr->d = 0.0;
+    return *itr;
+}
+
+void FlatUserValues::release(Entry& entry)
+{
+    if (entry.type == Type::Object && entry.object) entry.object->unref();
+    entry.object = nullptr;
+}
+
+void FlatUserValues::setObject(Id id, ref_ptr<Object> object)
+{
+    if (!object)
+    {
+        remove(id);
+        return;
+    }
+
+    Entry& entry = assign(id, Type::Object);
+    object->ref();
+    entry.object = object.get();
+}
+
+Object* FlatUserValues::getObject(Id id) const
+{
+    const Entry* entry = find(id);
+    return (entry && entry->type == Type::Object) ? entry->object : nullptr;
+}
+
+bool FlatUserValues::remove(Id id)
+{
+    auto itr = std::lower_bound(_entries.begin(), _entries.end(), id, KeyLess());
+    if (itr == _entries.end() || itr->key != id) return false;
+
+    release(*itr);
+    _entries.erase(itr);
+    return true;
+}
+
+void FlatUserValues::clear()
+{
+    for (auto& entry : _entries) release(entry);
+    _entries.clear();
+}
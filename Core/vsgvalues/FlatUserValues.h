@@ -0,0 +1,190 @@
+#pragma once
+
+#include <vsg/core/Object.h>
+#include <vsg/core/Value.h>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "StringInterner.h"
+
+namespace vsg
+{
+
+    //
+    // FlatUserValues is a compact alternative to the Auxiliary ObjectMap for attaching user values to large numbers of objects.
+    // Keys are interned once through StringInterner::instance() and the values held in a small vector sorted by key id, each entry
+    // is 16 bytes. bool, int, unsigned int, float and double are stored inline rather than as separate Value objects, other types
+    // are held as Value<T> objects as Auxiliary does. As with Object::getValue(), getValue() only succeeds for the type that was set.
+    //
+    class FlatUserValues
+    {
+    public:
+        using Id = StringInterner::Id;
+
+        enum class Type : uint8_t
+        {
+            Bool,
+            Int,
+            UInt,
+            Float,
+            Double,
+            Object
+        };
+
+        struct Entry
+        {
+            Id key;
+            Type type;
+            union
+            {
+                bool b;
+                int i;
+                unsigned int u;
+                float f;
+                double d;
+                vsg::Object* object;
+            };
+        };
+
+        FlatUserValues() {}
+        FlatUserValues(const FlatUserValues& rhs);
+        FlatUserValues(FlatUserValues&& rhs) noexcept : _entries(std::move(rhs._entries)) {}
+        ~FlatUserValues() { clear(); }
+
+        FlatUserValues& operator=(const FlatUserValues& rhs);
+        FlatUserValues& operator=(FlatUserValues&& rhs) noexcept;
+
+        // the id used for key, interning it if required
+        static Id key(std::string_view name) { return StringInterner::instance().intern(name); }
+
+        // the name of a key id
+        static std::string_view name(Id id) { return StringInterner::instance().view(id); }
+
+        template<typename T>
+        static constexpr Type type()
+        {
+            if constexpr (std::is_same_v<T, bool>) return Type::Bool;
+            else if constexpr (std::is_same_v<T, int>) return Type::Int;
+            else if constexpr (std::is_same_v<T, unsigned int>) return Type::UInt;
+            else if constexpr (std::is_same_v<T, float>) return Type::Float;
+            else if constexpr (std::is_same_v<T, double>) return Type::Double;
+            else return Type::Object;
+        }
+
+        // the inline value of an entry, T must match the entry's type
+        template<typename T>
+        static T& get(Entry& entry)
+        {
+            if constexpr (std::is_same_v<T, bool>) return entry.b;
+            else if constexpr (std::is_same_v<T, int>) return entry.i;
+            else if constexpr (std::is_same_v<T, unsigned int>) return entry.u;
+            else if constexpr (std::is_same_v<T, float>) return entry.f;
+            else return entry.d;
+        }
+
+        template<typename T>
+        static const T& get(const Entry& entry) { return get<T>(const_cast<Entry&>(entry)); }
+
+        template<typename T>
+        void setValue(Id id, const T& value)
+        {
+            if constexpr (type<T>() == Type::Object)
+            {
+                countAllocation();
+                setObject(id, Value<T>::create(value));
+            }
+            else
+            {
+                Entry& entry = assign(id, type<T>());
+                get<T>(entry) = value;
+            }
+        }
+
+        template<typename T>
+        void setValue(std::string_view name, const T& value) { setValue(key(name), value); }
+
+        // string literals are stored as stringValue, matching Object::setValue()
+        void setValue(Id id, const char* value) { setValue(id, std::string(value)); }
+        void setValue(std::string_view name, const char* value) { setValue(key(name), std::string(value)); }
+
+        template<typename T>
+        bool getValue(Id id, T& value) const
+        {
+            const Entry* entry = find(id);
+            if (!entry || entry->type != type<T>()) return false;
+
+            if constexpr (type<T>() == Type::Object)
+            {
+                auto object = dynamic_cast<const Value<T>*>(entry->object);
+                if (!object) return false;
+                value = object->value();
+            }
+            else
+            {
+                value = get<T>(*entry);
+            }
+            return true;
+        }
+
+        // looking up a name that has never been interned doesn't add it
+        template<typename T>
+        bool getValue(std::string_view name, T& value) const { return getValue(StringInterner::instance().find(name), value); }
+
+        void setObject(Id id, ref_ptr<Object> object);
+        void setObject(std::string_view name, ref_ptr<Object> object) { setObject(key(name), object); }
+
+        Object* getObject(Id id) const;
+        Object* getObject(std::string_view name) const { return getObject(StringInterner::instance().find(name)); }
+
+        bool remove(Id id);
+        void clear();
+
+        const Entry* find(Id id) const;
+
+        std::size_t size() const { return _entries.size(); }
+        bool empty() const { return _entries.empty(); }
+
+        // release the spare capacity left by growing the entries, for objects whose values are set once then only read
+        void shrink_to_fit() { _entries.shrink_to_fit(); }
+
+        // heap allocations made by all FlatUserValues so far, for growing the entries and creating Value objects, for benchmarking
+        static std::size_t numAllocations();
+
+        // bytes used by the entries, excluding any Value objects they refer to
+        std::size_t memoryUsage() const { return sizeof(FlatUserValues) + _entries.capacity() * sizeof(Entry); }
+
+        // call functor(name, value) for each entry in key id order, value is passed as bool, int, unsigned int, float, double or Object&
+        template<typename F>
+        void for_each(F functor) const
+        {
+            for (auto& entry : _entries)
+            {
+                auto keyName = name(entry.key);
+                switch (entry.type)
+                {
+                case Type::Bool: functor(keyName, entry.b); break;
+                case Type::Int: functor(keyName, entry.i); break;
+                case Type::UInt: functor(keyName, entry.u); break;
+                case Type::Float: functor(keyName, entry.f); break;
+                case Type::Double: functor(keyName, entry.d); break;
+                case Type::Object: functor(keyName, *entry.object); break;
+                }
+            }
+        }
+
+    protected:
+        // find or insert the entry for id, releasing any object it held and setting its type
+        Entry& assign(Id id, Type type);
+
+        static void release(Entry& entry);
+
+        static void countAllocation();
+
+        std::vector<Entry> _entries;
+    };
+
+} // namespace vsg
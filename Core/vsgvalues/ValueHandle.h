@@ -0,0 +1,103 @@
+#pragma once
+
+#include <vsg/core/Auxiliary.h>
+#include <vsg/core/Object.h>
+#include <vsg/core/Value.h>
+
+#include <string>
+
+#include "FlatUserValues.h"
+
+namespace vsg
+{
+
+    //
+    // ValueHandle<T> resolves a user value once, looking up the key and checking its type, then gives direct access to the value
+    // with no string comparisons, map lookups or dynamic_cast on each read. Intended for per frame reads of attributes that are
+    // set up front, resolve the handles after the values are assigned and keep them alongside the objects they refer to.
+    //
+    // A handle on an Object keeps a reference to the Value<T> it resolved, so is always safe to read, but Object::setValue() replaces
+    // the Value object so the handle needs resolving again to see a new value. A handle on a FlatUserValues points into its entries,
+    // setting the value through the handle or with the same type through setValue() is seen, adding or removing keys invalidates it.
+    //
+    template<typename T>
+    class ValueHandle
+    {
+    public:
+        using value_type = T;
+
+        ValueHandle() {}
+
+        ValueHandle(Object& object, const std::string& key) { resolve(object, key); }
+
+        ValueHandle(FlatUserValues& values, FlatUserValues::Id key) { resolve(values, key); }
+
+        ValueHandle(FlatUserValues& values, std::string_view key) { resolve(values, StringInterner::instance().find(key)); }
+
+        bool resolve(Object& object, const std::string& key)
+        {
+            reset();
+            if (auto auxiliary = object.getAuxiliary())
+            {
+                auto& objectMap = auxiliary->getObjectMap();
+                auto itr = objectMap.find(key);
+                if (itr != objectMap.end())
+                {
+                    if (auto value = dynamic_cast<Value<T>*>(itr->second.get()))
+                    {
+                        _object = value;
+                        _value = &(value->value());
+                    }
+                }
+            }
+            return valid();
+        }
+
+        bool resolve(FlatUserValues& values, FlatUserValues::Id key)
+        {
+            reset();
+            auto entry = const_cast<FlatUserValues::Entry*>(values.find(key));
+            if (!entry || entry->type != FlatUserValues::type<T>()) return false;
+
+            if constexpr (FlatUserValues::type<T>() == FlatUserValues::Type::Object)
+            {
+                if (auto value = dynamic_cast<Value<T>*>(entry->object))
+                {
+                    _object = value;
+                    _value = &(value->value());
+                }
+            }
+            else
+            {
+                _value = &FlatUserValues::get<T>(*entry);
+            }
+            return valid();
+        }
+
+        void reset()
+        {
+            _object = {};
+            _value = nullptr;
+        }
+
+        bool valid() const { return _value != nullptr; }
+        explicit operator bool() const { return valid(); }
+
+        // only call when valid()
+        T& value() { return *_value; }
+        const T& value() const { return *_value; }
+
+        // matches Object::getValue(), returns false if the handle didn't resolve
+        bool get(T& value) const
+        {
+            if (!_value) return false;
+            value = *_value;
+            return true;
+        }
+
+    protected:
+        ref_ptr<Object> _object;
+        T* _value = nullptr;
+    };
+
+} // namespace vsg
@@ -2,10 +2,25 @@
 #include <vsg/core/Auxiliary.h>
 #include <vsg/core/Value.h>
 #include <vsg/core/Visitor.h>
+#include <vsg/utils/CommandLine.h>
 
 #include <iostream>
 #include <typeinfo>
 #include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "FlatUserValues.h"
+#include "ValueHandle.h"
+
+// heap allocations held by an object and its user values, counted from its Auxiliary: the Object, the Auxiliary,
+// and an ObjectMap node and Value object for each key. The short keys used here fit std::string's inline buffer.
+std::size_t numAllocations(const vsg::Object& object)
+{
+    auto auxiliary = object.getAuxiliary();
+    if (!auxiliary) return 1;
+    return 2 + 2 * auxiliary->getObjectMap().size();
+}
 
 // helper function to simplify iteration through any user objects/values assigned to an object.
 template<typename P, typename F>
@@ -24,8 +39,13 @@ void for_each_user_object(P object, F functor)
     }
 }
 
-int main(int /*argc*/, char** /*argv*/)
+int main(int argc, char** argv)
 {
+    vsg::CommandLine arguments(&argc, argv);
+    auto numFeatures = arguments.value<std::size_t>(100000, {"-f", "--features"});
+    auto numFrames = arguments.value(100u, "--frames");
+    if (arguments.errors()) return arguments.writeErrorMessages(std::cerr);
+
     vsg::ref_ptr<vsg::Object> object(new vsg::Object());
     object->setValue("name", "Name field contents");
     object->setValue("time", 10.0);
@@ -98,7 +118,153 @@ int main(int /*argc*/, char** /*argv*/)
 
     }
 
+    // the same values in FlatUserValues, the scalars are stored inline rather than as separate Value objects
+    vsg::FlatUserValues flatValues;
+    flatValues.setValue("name", "Name field contents");
+    flatValues.setValue("time", 10.0);
+    flatValues.setValue("size", 3.1f);
+    flatValues.setValue("count", 5);
+    flatValues.setValue("pos", 4u);
+
+    std::cout<<"FlatUserValues size = "<<flatValues.size()<<", memoryUsage = "<<flatValues.memoryUsage()<<" bytes"<<std::endl;
+    flatValues.for_each([](std::string_view key, auto& value)
+    {
+        using T = std::decay_t<decltype(value)>;
+        std::cout<<"   key["<<key<<"] ";
+        if constexpr (std::is_base_of_v<vsg::Object, T>)
+        {
+            if (auto str = dynamic_cast<vsg::stringValue*>(&value)) std::cout<<"stringValue, value  = "<<str->value()<<std::endl;
+            else std::cout<<"Object, "<<typeid(value).name()<<std::endl;
+        }
+        else
+        {
+            std::cout<<"inline value = "<<value<<std::endl;
+        }
+    });
+
+    // attach metadata to numFeatures objects through the Auxiliary ObjectMap and through FlatUserValues, then read one value back from each
+    {
+        auto setup = [](auto& values, std::size_t i)
+        {
+            values.setValue("id", static_cast<unsigned int>(i));
+            values.setValue("height", 10.0f + float(i % 100));
+            values.setValue("population", static_cast<int>(i % 5000));
+            values.setValue("visible", (i % 2) == 0);
+        };
+
+        std::vector<vsg::ref_ptr<vsg::Object>> objects(numFeatures);
+        std::vector<vsg::FlatUserValues> flatFeatures(numFeatures);
+
+        // intern the keys up front so the first feature's setup time doesn't include interning them
+        vsg::FlatUserValues keys;
+        setup(keys, 0);
+
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < numFeatures; ++i)
+        {
+            objects[i] = new vsg::Object;
+            setup(*objects[i], i);
+        }
+        double auxiliarySetupTime = std::chrono::duration<double, std::chrono::milliseconds::period>(std::chrono::steady_clock::now() - start).count();
+
+        std::size_t auxiliaryAllocations = 0;
+        for (auto& object : objects) auxiliaryAllocations += numAllocations(*object);
+
+        std::size_t allocations = vsg::FlatUserValues::numAllocations();
+        start = std::chrono::steady_clock::now();
+        for (std::size_t i = 0; i < numFeatures; ++i) setup(flatFeatures[i], i);
+        double flatSetupTime = std::chrono::duration<double, std::chrono::milliseconds::period>(std::chrono::steady_clock::now() - start).count();
+        std::size_t flatAllocations = vsg::FlatUserValues::numAllocations() - allocations;
+
+        float auxiliarySum = 0.0f;
+        start = std::chrono::steady_clock::now();
+        for (auto& object : objects)
+        {
+            float height = 0.0f;
+            if (object->getValue("height", height)) auxiliarySum += height;
+        }
+        double auxiliaryReadTime = std::chrono::duration<double, std::chrono::milliseconds::period>(std::chrono::steady_clock::now() - start).count();
+
+        float flatSum = 0.0f;
+        start = std::chrono::steady_clock::now();
+        for (auto& values : flatFeatures)
+        {
+            float height = 0.0f;
+            if (values.getValue("height", height)) flatSum += height;
+        }
+        double flatReadTime = std::chrono::duration<double, std::chrono::milliseconds::period>(std::chrono::steady_clock::now() - start).count();
+
+        std::size_t flatBytes = 0;
+        for (auto& values : flatFeatures) flatBytes += values.memoryUsage();
+
+        std::cout<<"\n"<<numFeatures<<" features with 4 values each"<<std::endl;
+        std::cout<<"    Auxiliary ObjectMap : "<<double(auxiliaryAllocations)/double(numFeatures)<<" heap allocations/feature, setup "<<auxiliarySetupTime<<"ms, read "<<auxiliaryReadTime<<"ms, sum "<<auxiliarySum<<std::endl;
+        std::cout<<"    FlatUserValues      : "<<double(flatAllocations)/double(numFeatures)<<" heap allocations/feature, "<<double(flatBytes)/double(numFeatures)<<" bytes/feature, setup "<<flatSetupTime<<"ms, read "<<flatReadTime<<"ms, sum "<<flatSum<<std::endl;
+
+        // per frame reads of the same attribute from every feature, the handles are resolved once up front
+        auto frameTime = [numFrames](auto readFrame)
+        {
+            float sum = 0.0f;
+            auto frameStart = std::chrono::steady_clock::now();
+            for (unsigned int frame = 0; frame < numFrames; ++frame) sum += readFrame();
+            double duration = std::chrono::duration<double, std::chrono::milliseconds::period>(std::chrono::steady_clock::now() - frameStart).count() / double(numFrames);
+            return std::make_pair(duration, sum / float(numFrames));
+        };
+
+        start = std::chrono::steady_clock::now();
+        std::vector<vsg::ValueHandle<float>> objectHandles(numFeatures);
+        std::vector<vsg::ValueHandle<float>> flatHandles(numFeatures);
+        for (std::size_t i = 0; i < numFeatures; ++i)
+        {
+            objectHandles[i].resolve(*objects[i], "height");
+            flatHandles[i].resolve(flatFeatures[i], vsg::FlatUserValues::key("height"));
+        }
+        double resolveTime = std::chrono::duration<double, std::chrono::milliseconds::period>(std::chrono::steady_clock::now() - start).count();
+
+        auto getValueFrame = frameTime([&]() {
+            float sum = 0.0f;
+            for (auto& object : objects)
+            {
+                float height = 0.0f;
+                if (object->getValue("height", height)) sum += height;
+            }
+            return sum;
+        });
+
+        auto heightKey = vsg::FlatUserValues::key("height");
+        auto flatKeyFrame = frameTime([&]() {
+            float sum = 0.0f;
+            for (auto& values : flatFeatures)
+            {
+                float height = 0.0f;
+                if (values.getValue(heightKey, height)) sum += height;
+            }
+            return sum;
+        });
+
+        auto objectHandleFrame = frameTime([&]() {
+            float sum = 0.0f;
+            for (auto& handle : objectHandles) sum += handle.value();
+            return sum;
+        });
 
+        auto flatHandleFrame = frameTime([&]() {
+            float sum = 0.0f;
+            for (auto& handle : flatHandles) sum += handle.value();
+            return sum;
+        });
+
+        auto reportFrame = [&](const char* name, const std::pair<double, float>& result)
+        {
+            std::cout<<"    "<<name<<result.first<<"ms/frame, speedup "<<getValueFrame.first/result.first<<", sum "<<result.second<<std::endl;
+        };
+
+        std::cout<<"\n"<<numFrames<<" frames reading height from "<<numFeatures<<" features, handles resolved in "<<resolveTime<<"ms"<<std::endl;
+        reportFrame("Object::getValue(name)        : ", getValueFrame);
+        reportFrame("FlatUserValues::getValue(id)  : ", flatKeyFrame);
+        reportFrame("ValueHandle<float> on Object  : ", objectHandleFrame);
+        reportFrame("ValueHandle<float> on Flat    : ", flatHandleFrame);
+    }
 
     return 0;
 }
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <vsg/all.h>
+
+namespace vsg
+{
+
+    //
+    // ComputeBarrier command, makes shader writes from prior dispatches visible to subsequent dispatches or transfers
+    //
+    class ComputeBarrier : public Inherit<Command, ComputeBarrier>
+    {
+    public:
+        ComputeBarrier(VkPipelineStageFlags dstStageMask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VkAccessFlags dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT) :
+            _dstStageMask(dstStageMask),
+            _dstAccessMask(dstAccessMask) {}
+
+        void dispatch(CommandBuffer& commandBuffer) const override
+        {
+            VkMemoryBarrier barrier = {};
+            barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+            barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+            barrier.dstAccessMask = _dstAccessMask;
+            vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, _dstStageMask, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+        }
+
+    protected:
+        VkPipelineStageFlags _dstStageMask;
+        VkAccessFlags _dstAccessMask;
+    };
+    VSG_type_name(ComputeBarrier)
+
+}
@@ -0,0 +1,216 @@
+#include "GeometryBuilder.h"
+#include "VertexLayout.h"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+
+using namespace vsg;
+
+namespace
+{
+    constexpr uint32_t invalidIndex = std::numeric_limits<uint32_t>::max();
+
+    const char* indexTypeName(VkIndexType type)
+    {
+        switch (type)
+        {
+        case VK_INDEX_TYPE_UINT8_EXT: return "uint8";
+        case VK_INDEX_TYPE_UINT16: return "uint16";
+        case VK_INDEX_TYPE_UINT32: return "uint32";
+        default: return "unknown";
+        }
+    }
+} // namespace
+
+IndexSupport IndexSupport::from(PhysicalDevice* physicalDevice)
+{
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(*physicalDevice, &properties);
+
+    IndexSupport support;
+    support.maxIndexValue = properties.limits.maxDrawIndexedIndexValue;
+    return support;
+}
+
+VkIndexType vsg::indexType(uint32_t numVertices, const IndexSupport& support)
+{
+    if (support.uint8 && numVertices <= 0xff) return VK_INDEX_TYPE_UINT8_EXT;
+    if (numVertices <= 0xffff) return VK_INDEX_TYPE_UINT16;
+    return VK_INDEX_TYPE_UINT32;
+}
+
+ref_ptr<Data> vsg::createIndices(const std::vector<uint32_t>& values, VkIndexType type)
+{
+    auto size = static_cast<uint32_t>(values.size());
+    ref_ptr<Data> indices;
+    switch (type)
+    {
+    case VK_INDEX_TYPE_UINT8_EXT: indices = ubyteArray::create(size); break;
+    case VK_INDEX_TYPE_UINT16: indices = ushortArray::create(size); break;
+    default: indices = uintArray::create(size); break;
+    }
+    writeIndices(indices, values);
+    return indices;
+}
+
+ref_ptr<Data> vsg::remapArray(const Data* data, const std::vector<uint32_t>& newToOld)
+{
+    auto remap = [&](auto& array) {
+        using ArrayType = std::decay_t<decltype(array)>;
+        auto remapped = ArrayType::create(static_cast<uint32_t>(newToOld.size()));
+        for (size_t i = 0; i < newToOld.size(); ++i) (*remapped)[i] = array[newToOld[i]];
+        return ref_ptr<Data>(remapped);
+    };
+
+    if (auto vec3s = dynamic_cast<const vec3Array*>(data)) return remap(*vec3s);
+    if (auto vec2s = dynamic_cast<const vec2Array*>(data)) return remap(*vec2s);
+    if (auto vec4s = dynamic_cast<const vec4Array*>(data)) return remap(*vec4s);
+    if (auto floats = dynamic_cast<const floatArray*>(data)) return remap(*floats);
+    if (auto ubvec4s = dynamic_cast<const ubvec4Array*>(data)) return remap(*ubvec4s);
+    return {};
+}
+
+bool vsg::canRemapArray(const Data* data)
+{
+    return dynamic_cast<const vec3Array*>(data) || dynamic_cast<const vec2Array*>(data) || dynamic_cast<const vec4Array*>(data) ||
+           dynamic_cast<const floatArray*>(data) || dynamic_cast<const ubvec4Array*>(data);
+}
+
+//
+// BindIndexBufferUInt8
+//
+BindIndexBufferUInt8::BindIndexBufferUInt8(ref_ptr<Data> indices) :
+    _indices(indices)
+{
+}
+
+BindIndexBufferUInt8::BindIndexBufferUInt8(const BufferData& bufferData) :
+    _indices(bufferData._data),
+    _bufferData(bufferData)
+{
+}
+
+void BindIndexBufferUInt8::compile(Context& context)
+{
+    if (_bufferData._buffer || !_indices) return;
+
+    auto bufferDataList = createBufferAndTransferData(context, DataList{_indices}, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE);
+    if (!bufferDataList.empty()) _bufferData = bufferDataList.front();
+}
+
+void BindIndexBufferUInt8::dispatch(CommandBuffer& commandBuffer) const
+{
+    vkCmdBindIndexBuffer(commandBuffer, *_bufferData._buffer, _bufferData._offset, VK_INDEX_TYPE_UINT8_EXT);
+}
+
+ref_ptr<Command> vsg::createBindIndexBuffer(ref_ptr<Data> indices)
+{
+    if (dynamic_cast<ubyteArray*>(indices.get())) return BindIndexBufferUInt8::create(indices);
+    return BindIndexBuffer::create(indices);
+}
+
+ref_ptr<Command> vsg::createBindIndexBuffer(const BufferData& bufferData)
+{
+    if (dynamic_cast<const ubyteArray*>(bufferData._data.get())) return BindIndexBufferUInt8::create(bufferData);
+    return BindIndexBuffer::create(bufferData);
+}
+
+//
+// GeometryBuilder
+//
+GeometryBuilder::GeometryBuilder(const IndexSupport& in_support) :
+    support(in_support)
+{
+}
+
+ref_ptr<Commands> GeometryBuilder::build(const DataList& vertexArrays, const Data* indices, const DataList& instanceArrays, uint32_t instanceCount, uint32_t firstBinding)
+{
+    return build(vertexArrays, readIndices(indices), instanceArrays, instanceCount, firstBinding);
+}
+
+ref_ptr<Commands> GeometryBuilder::build(const DataList& vertexArrays, const std::vector<uint32_t>& indices, const DataList& instanceArrays, uint32_t instanceCount, uint32_t firstBinding)
+{
+    numParts = 0;
+    indexDataSize = 0;
+    uint32DataSize = indices.size() * sizeof(uint32_t);
+
+    auto commands = Commands::create();
+    if (vertexArrays.empty() || !vertexArrays.front() || indices.empty()) return commands;
+
+    auto addPart = [&](const DataList& arrays, const std::vector<uint32_t>& partIndices, uint32_t partVertices) {
+        DataList boundArrays(arrays);
+        boundArrays.insert(boundArrays.end(), instanceArrays.begin(), instanceArrays.end());
+
+        lastIndexType = indexType(partVertices, support);
+        auto indexArray = createIndices(partIndices, lastIndexType);
+
+        commands->addChild(BindVertexBuffers::create(firstBinding, boundArrays));
+        commands->addChild(createBindIndexBuffer(indexArray));
+        commands->addChild(DrawIndexed::create(static_cast<uint32_t>(partIndices.size()), instanceCount, 0, 0, 0));
+
+        ++numParts;
+        indexDataSize += indexArray->dataSize();
+    };
+
+    uint32_t numVertices = vertexArrays.front()->valueCount();
+    uint32_t deviceLimit = support.maxIndexValue == invalidIndex ? invalidIndex : support.maxIndexValue + 1;
+    uint32_t partLimit = std::max(splitLargeMeshes ? std::min(maxPartVertices, deviceLimit) : deviceLimit, 3u);
+
+    bool canSplit = indices.size() % 3 == 0;
+    for (auto& array : vertexArrays) canSplit = canSplit && array && array->valueCount() == numVertices && canRemapArray(array);
+    for (auto index : indices) canSplit = canSplit && index < numVertices;
+
+    if (numVertices <= partLimit || !canSplit)
+    {
+        if (numVertices > deviceLimit) std::cout << "Warning: GeometryBuilder unable to split mesh of " << numVertices << " vertices, the device can only index " << deviceLimit << std::endl;
+        addPart(vertexArrays, indices, numVertices);
+        return commands;
+    }
+
+    // gather triangles in order into parts of at most partLimit vertices, each part with its own copy of the vertices it uses
+    std::vector<uint32_t> localIndex(numVertices, invalidIndex);
+    std::vector<uint32_t> newToOld;
+    std::vector<uint32_t> partIndices;
+    newToOld.reserve(partLimit);
+
+    auto flush = [&]() {
+        DataList partArrays;
+        for (auto& array : vertexArrays) partArrays.push_back(remapArray(array, newToOld));
+        addPart(partArrays, partIndices, static_cast<uint32_t>(newToOld.size()));
+
+        for (auto v : newToOld) localIndex[v] = invalidIndex;
+        newToOld.clear();
+        partIndices.clear();
+    };
+
+    for (size_t i = 0; i < indices.size(); i += 3)
+    {
+        uint32_t numNew = 0;
+        for (size_t c = 0; c < 3; ++c)
+        {
+            if (localIndex[indices[i + c]] == invalidIndex) ++numNew;
+        }
+        if (newToOld.size() + numNew > partLimit) flush();
+
+        for (size_t c = 0; c < 3; ++c)
+        {
+            uint32_t v = indices[i + c];
+            if (localIndex[v] == invalidIndex)
+            {
+                localIndex[v] = static_cast<uint32_t>(newToOld.size());
+                newToOld.push_back(v);
+            }
+            partIndices.push_back(localIndex[v]);
+        }
+    }
+    if (!partIndices.empty()) flush();
+
+    return commands;
+}
+
+void GeometryBuilder::report(std::ostream& out) const
+{
+    out << "GeometryBuilder " << numParts << (numParts == 1 ? " part" : " parts") << ", " << indexTypeName(lastIndexType) << " indices" << std::endl;
+    out << "    index data " << indexDataSize << " bytes, " << uint32DataSize << " bytes as uint32" << std::endl;
+}
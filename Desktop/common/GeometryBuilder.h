@@ -0,0 +1,88 @@
+#pragma once
+
+#include <vsg/all.h>
+
+#include <ostream>
+#include <vector>
+
+namespace vsg
+{
+
+    // the index types a device can draw with
+    struct IndexSupport
+    {
+        bool uint8 = false;                  // VK_EXT_index_type_uint8 enabled along with its indexTypeUint8 feature
+        uint32_t maxIndexValue = 0xffffffff; // VkPhysicalDeviceLimits::maxDrawIndexedIndexValue, 2^24-1 without the fullDrawIndexUint32 feature
+
+        // read the limits of a physical device, uint8 is left false as the extension has to be enabled when the device is created
+        static IndexSupport from(PhysicalDevice* physicalDevice);
+    };
+
+    // the narrowest index type able to address numVertices vertices. The largest value of each type is left free for primitive restart,
+    // so 8 bit indices are used for up to 255 vertices and 16 bit for up to 65535.
+    VkIndexType indexType(uint32_t numVertices, const IndexSupport& support = {});
+
+    // ubyteArray, ushortArray or uintArray holding values
+    ref_ptr<Data> createIndices(const std::vector<uint32_t>& values, VkIndexType type);
+
+    // a new array of the same type as data holding data[newToOld[i]], null for array types other than floatArray, vec2Array, vec3Array,
+    // vec4Array and ubvec4Array
+    ref_ptr<Data> remapArray(const Data* data, const std::vector<uint32_t>& newToOld);
+
+    // true if remapArray() supports data's array type
+    bool canRemapArray(const Data* data);
+
+    //
+    // BindIndexBufferUInt8 binds 8 bit indices, which vsg::BindIndexBuffer doesn't support. Requires VK_EXT_index_type_uint8.
+    //
+    class BindIndexBufferUInt8 : public Inherit<Command, BindIndexBufferUInt8>
+    {
+    public:
+        explicit BindIndexBufferUInt8(ref_ptr<Data> indices);
+        explicit BindIndexBufferUInt8(const BufferData& bufferData);
+
+        void compile(Context& context) override;
+        void dispatch(CommandBuffer& commandBuffer) const override;
+
+    protected:
+        ref_ptr<Data> _indices;
+        BufferData _bufferData;
+    };
+    VSG_type_name(BindIndexBufferUInt8)
+
+    // BindIndexBuffer for 16 and 32 bit indices, BindIndexBufferUInt8 for 8 bit
+    ref_ptr<Command> createBindIndexBuffer(ref_ptr<Data> indices);
+    ref_ptr<Command> createBindIndexBuffer(const BufferData& bufferData);
+
+    //
+    // GeometryBuilder sets up the bind and draw commands of an indexed mesh using the narrowest index type the device supports for its
+    // vertex count. Meshes with more vertices than maxPartVertices, or than the device's maxIndexValue can address, are split into
+    // parts that each get their own copy of the vertices they use, so large meshes can still use 16 bit indices.
+    //
+    class GeometryBuilder : public Inherit<Object, GeometryBuilder>
+    {
+    public:
+        explicit GeometryBuilder(const IndexSupport& in_support = {});
+
+        IndexSupport support;
+        uint32_t maxPartVertices = 0xffff;
+        bool splitLargeMeshes = true;
+
+        // commands binding vertexArrays from firstBinding, followed by instanceArrays, then drawing the indices instanceCount times.
+        // Indices are in groups of three when splitting, as a triangle list.
+        ref_ptr<Commands> build(const DataList& vertexArrays, const std::vector<uint32_t>& indices, const DataList& instanceArrays = {}, uint32_t instanceCount = 1, uint32_t firstBinding = 0);
+
+        // indices read from a ubyteArray, ushortArray or uintArray
+        ref_ptr<Commands> build(const DataList& vertexArrays, const Data* indices, const DataList& instanceArrays = {}, uint32_t instanceCount = 1, uint32_t firstBinding = 0);
+
+        void report(std::ostream& out) const;
+
+        // stats from the last build
+        uint32_t numParts = 0;
+        VkIndexType lastIndexType = VK_INDEX_TYPE_UINT32;
+        std::size_t indexDataSize = 0;  // bytes
+        std::size_t uint32DataSize = 0; // bytes the indices would take as uint32
+    };
+    VSG_type_name(GeometryBuilder)
+
+} // namespace vsg
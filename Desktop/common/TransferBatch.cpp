@@ -0,0 +1,205 @@
+#include "TransferBatch.h"
+
+#include <cstring>
+#include <iostream>
+
+using namespace vsg;
+
+//
+// TransferBatch
+//
+
+TransferBatch::TransferBatch(Device* device, uint32_t queueFamily, VkDeviceSize stagingSize) :
+    _device(device),
+    _queue(device->getQueue(queueFamily)),
+    _commandPool(CommandPool::create(device, queueFamily)),
+    _stagingSize(stagingSize)
+{
+    _stagingBuffer = Buffer::create(device, stagingSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_SHARING_MODE_EXCLUSIVE);
+    _stagingMemory = DeviceMemory::create(device, _stagingBuffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    _stagingBuffer->bind(_stagingMemory, 0);
+
+    // keep the staging memory mapped for the lifetime of the TransferBatch
+    void* data = nullptr;
+    if (vkMapMemory(*_device, *_stagingMemory, 0, stagingSize, 0, &data) == VK_SUCCESS)
+    {
+        _stagingData = static_cast<uint8_t*>(data);
+    }
+    else
+    {
+        std::cout << "Warning: TransferBatch unable to map staging memory." << std::endl;
+    }
+}
+
+TransferBatch::~TransferBatch()
+{
+    waitForCompletion();
+
+    if (_stagingData) vkUnmapMemory(*_device, *_stagingMemory);
+}
+
+VkDeviceSize TransferBatch::reserve(VkDeviceSize size)
+{
+    if (size > _stagingSize) return invalidOffset;
+
+    while (true)
+    {
+        if (_used == 0)
+        {
+            _head = _tail = _pendingBegin = 0;
+        }
+
+        VkDeviceSize offset = invalidOffset;
+        VkDeviceSize skipped = 0;
+        if (_used == 0 || _head > _tail)
+        {
+            if (_head + size <= _stagingSize)
+            {
+                offset = _head;
+            }
+            else if (size <= _tail)
+            {
+                // wrap around to the start of the ring buffer, the remaining space at the end is unused until the block is released
+                skipped = _stagingSize - _head;
+                offset = 0;
+            }
+        }
+        else if (_head < _tail && _head + size <= _tail)
+        {
+            offset = _head;
+        }
+
+        if (offset != invalidOffset)
+        {
+            if (_pendingCopies.empty()) _pendingBegin = _head;
+
+            _head = offset + size;
+            _used += size + skipped;
+            _pendingSize += size + skipped;
+            return offset;
+        }
+
+        // no space available, submit what is pending and wait for the oldest submission to free up its staging space
+        ++numStalls;
+        flush();
+
+        if (_submissions.empty()) return invalidOffset;
+
+        VkFence fence = *(_submissions.front().fence);
+        vkWaitForFences(*_device, 1, &fence, VK_TRUE, 100000000000);
+        collect();
+    }
+}
+
+BufferDataList TransferBatch::add(const DataList& dataList, VkBufferUsageFlags usage)
+{
+    if (!_stagingData || dataList.empty()) return {};
+
+    // pack all the arrays into one buffer, keeping each array aligned so it can be used as an index buffer
+    const VkDeviceSize alignment = 16;
+    std::vector<VkDeviceSize> offsets;
+    offsets.reserve(dataList.size());
+
+    VkDeviceSize totalSize = 0;
+    for (auto& data : dataList)
+    {
+        offsets.push_back(totalSize);
+        totalSize += ((data->dataSize() + alignment - 1) / alignment) * alignment;
+    }
+
+    VkDeviceSize stagingOffset = reserve(totalSize);
+    if (stagingOffset == invalidOffset)
+    {
+        std::cout << "Warning: TransferBatch unable to reserve " << totalSize << " bytes of staging memory." << std::endl;
+        return {};
+    }
+
+    auto buffer = Buffer::create(_device, totalSize, usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_SHARING_MODE_EXCLUSIVE);
+    auto memory = DeviceMemory::create(_device, buffer, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    buffer->bind(memory, 0);
+
+    BufferDataList bufferDataList;
+    bufferDataList.reserve(dataList.size());
+    for (size_t i = 0; i < dataList.size(); ++i)
+    {
+        auto& data = dataList[i];
+        std::memcpy(_stagingData + stagingOffset + offsets[i], data->dataPointer(), data->dataSize());
+        bufferDataList.emplace_back(buffer, offsets[i], data->dataSize(), data);
+    }
+
+    _pendingCopies.push_back(Copy{buffer, VkBufferCopy{stagingOffset, 0, totalSize}});
+
+    ++numUploads;
+    numBytes += totalSize;
+
+    return bufferDataList;
+}
+
+void TransferBatch::flush()
+{
+    if (_pendingCopies.empty()) return;
+
+    auto commandBuffer = CommandBuffer::create(_device, _commandPool, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(*commandBuffer, &beginInfo);
+
+    for (auto& copy : _pendingCopies)
+    {
+        vkCmdCopyBuffer(*commandBuffer, *_stagingBuffer, *copy.buffer, 1, &copy.region);
+    }
+
+    // make the transfers visible to all subsequent submissions on this queue, so rendering doesn't need to wait on the fence
+    VkMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(*commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    vkEndCommandBuffer(*commandBuffer);
+
+    auto fence = Fence::create(_device);
+
+    VkCommandBuffer vk_commandBuffer = *commandBuffer;
+
+    VkSubmitInfo submitInfo = {};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &vk_commandBuffer;
+    if (_queue->submit(submitInfo, fence) != VK_SUCCESS)
+    {
+        std::cout << "Warning: TransferBatch unable to submit transfers." << std::endl;
+    }
+
+    _submissions.push_back(Submission{fence, commandBuffer, _pendingBegin, _pendingSize, std::move(_pendingCopies)});
+
+    _pendingCopies.clear();
+    _pendingBegin = _head;
+    _pendingSize = 0;
+
+    ++numSubmissions;
+}
+
+void TransferBatch::collect(bool wait)
+{
+    while (!_submissions.empty())
+    {
+        auto& submission = _submissions.front();
+
+        VkFence fence = *submission.fence;
+        VkResult result = wait ? vkWaitForFences(*_device, 1, &fence, VK_TRUE, 100000000000) : vkGetFenceStatus(*_device, fence);
+        if (result != VK_SUCCESS) break;
+
+        // submissions complete in order so the tail simply moves on to the next live block, popping the submission frees its command buffer
+        _used -= submission.size;
+        _submissions.pop_front();
+        _tail = _submissions.empty() ? _pendingBegin : _submissions.front().begin;
+    }
+}
+
+void TransferBatch::report(std::ostream& out) const
+{
+    out << "TransferBatch numUploads = " << numUploads << ", numBytes = " << numBytes << ", numSubmissions = " << numSubmissions << ", numStalls = " << numStalls << std::endl;
+}
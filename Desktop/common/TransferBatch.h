@@ -0,0 +1,84 @@
+#pragma once
+
+#include <vsg/all.h>
+
+#include <deque>
+#include <ostream>
+
+namespace vsg
+{
+
+    //
+    // TransferBatch sub-allocates uploads from a single persistently mapped staging ring buffer,
+    // records all the pending copies into one command buffer on flush() and tracks completion with a fence per submission,
+    // so callers never wait on an individual upload. Staging space is only waited on when the ring buffer is full.
+    //
+    class TransferBatch : public Inherit<Object, TransferBatch>
+    {
+    public:
+        TransferBatch(Device* device, uint32_t queueFamily, VkDeviceSize stagingSize = 16 * 1024 * 1024);
+
+        // copy the data into the staging buffer and queue a copy to a new device local buffer, the returned BufferDataList can be used straight away to set up BindVertexBuffers/BindIndexBuffer.
+        BufferDataList add(const DataList& dataList, VkBufferUsageFlags usage);
+
+        // record and submit all the pending copies, does not wait for them to complete.
+        void flush();
+
+        // release the staging space of completed submissions, if wait is true block until all submissions have completed.
+        void collect(bool wait = false);
+
+        void waitForCompletion() { flush(); collect(true); }
+
+        void report(std::ostream& out) const;
+
+        // stats
+        uint32_t numUploads = 0;
+        VkDeviceSize numBytes = 0;
+        uint32_t numSubmissions = 0;
+        uint32_t numStalls = 0;
+
+    protected:
+        virtual ~TransferBatch();
+
+        static constexpr VkDeviceSize invalidOffset = ~VkDeviceSize(0);
+
+        VkDeviceSize reserve(VkDeviceSize size);
+
+        struct Copy
+        {
+            ref_ptr<Buffer> buffer;
+            VkBufferCopy region;
+        };
+
+        struct Submission
+        {
+            ref_ptr<Fence> fence;
+            ref_ptr<CommandBuffer> commandBuffer;
+            VkDeviceSize begin;
+            VkDeviceSize size;
+            std::vector<Copy> copies;
+        };
+
+        ref_ptr<Device> _device;
+        ref_ptr<Queue> _queue;
+        ref_ptr<CommandPool> _commandPool;
+
+        ref_ptr<Buffer> _stagingBuffer;
+        ref_ptr<DeviceMemory> _stagingMemory;
+        VkDeviceSize _stagingSize;
+        uint8_t* _stagingData = nullptr;
+
+        // ring buffer state, _used includes any space skipped when wrapping around
+        VkDeviceSize _head = 0;
+        VkDeviceSize _tail = 0;
+        VkDeviceSize _used = 0;
+
+        VkDeviceSize _pendingBegin = 0;
+        VkDeviceSize _pendingSize = 0;
+        std::vector<Copy> _pendingCopies;
+
+        std::deque<Submission> _submissions;
+    };
+    VSG_type_name(TransferBatch)
+
+}
@@ -0,0 +1,382 @@
+#include "VertexLayout.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+using namespace vsg;
+
+namespace
+{
+    uint16_t floatToHalf(float value)
+    {
+        uint32_t f;
+        std::memcpy(&f, &value, sizeof(f));
+
+        uint32_t sign = (f >> 16) & 0x8000;
+        uint32_t floatExponent = (f >> 23) & 0xff;
+        uint32_t mantissa = f & 0x7fffff;
+
+        // infinity and NaN
+        if (floatExponent == 0xff) return static_cast<uint16_t>(sign | 0x7c00 | (mantissa ? 0x200 : 0));
+
+        int32_t exponent = int32_t(floatExponent) - 127 + 15;
+        if (exponent >= 31) return static_cast<uint16_t>(sign | 0x7c00);
+
+        // round to nearest even, a carry out of the mantissa correctly increments the exponent
+        auto round = [](uint32_t half, uint32_t remainder, uint32_t halfway) {
+            return (remainder > halfway || (remainder == halfway && (half & 1))) ? half + 1 : half;
+        };
+
+        if (exponent <= 0)
+        {
+            // denormal or zero
+            if (exponent < -10) return static_cast<uint16_t>(sign);
+            mantissa |= 0x800000;
+            uint32_t shift = static_cast<uint32_t>(14 - exponent);
+            uint32_t half = mantissa >> shift;
+            return static_cast<uint16_t>(sign | round(half, mantissa & ((1u << shift) - 1), 1u << (shift - 1)));
+        }
+
+        uint32_t half = (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+        return static_cast<uint16_t>(sign | round(half, mantissa & 0x1fff, 0x1000));
+    }
+
+    template<typename T>
+    T normalized(float value, float minValue)
+    {
+        constexpr float maxValue = float(std::numeric_limits<T>::max());
+        return static_cast<T>(std::lround(std::min(std::max(value, minValue), 1.0f) * maxValue));
+    }
+
+    uint32_t componentSize(VertexLayout::Encoding encoding)
+    {
+        switch (encoding)
+        {
+        case VertexLayout::Encoding::Float: return 4;
+        case VertexLayout::Encoding::Half:
+        case VertexLayout::Encoding::SNorm16:
+        case VertexLayout::Encoding::UNorm16: return 2;
+        default: return 1;
+        }
+    }
+
+    VkFormat format(VertexLayout::Encoding encoding, uint32_t numComponents)
+    {
+        uint32_t i = numComponents - 1;
+        switch (encoding)
+        {
+        case VertexLayout::Encoding::Float:
+        {
+            const VkFormat formats[] = {VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT};
+            return formats[i];
+        }
+        case VertexLayout::Encoding::Half:
+        {
+            const VkFormat formats[] = {VK_FORMAT_R16_SFLOAT, VK_FORMAT_R16G16_SFLOAT, VK_FORMAT_R16G16B16_SFLOAT, VK_FORMAT_R16G16B16A16_SFLOAT};
+            return formats[i];
+        }
+        case VertexLayout::Encoding::SNorm16:
+        {
+            const VkFormat formats[] = {VK_FORMAT_R16_SNORM, VK_FORMAT_R16G16_SNORM, VK_FORMAT_R16G16B16_SNORM, VK_FORMAT_R16G16B16A16_SNORM};
+            return formats[i];
+        }
+        case VertexLayout::Encoding::UNorm16:
+        {
+            const VkFormat formats[] = {VK_FORMAT_R16_UNORM, VK_FORMAT_R16G16_UNORM, VK_FORMAT_R16G16B16_UNORM, VK_FORMAT_R16G16B16A16_UNORM};
+            return formats[i];
+        }
+        case VertexLayout::Encoding::SNorm8:
+        {
+            const VkFormat formats[] = {VK_FORMAT_R8_SNORM, VK_FORMAT_R8G8_SNORM, VK_FORMAT_R8G8B8_SNORM, VK_FORMAT_R8G8B8A8_SNORM};
+            return formats[i];
+        }
+        case VertexLayout::Encoding::UNorm8:
+        {
+            const VkFormat formats[] = {VK_FORMAT_R8_UNORM, VK_FORMAT_R8G8_UNORM, VK_FORMAT_R8G8B8_UNORM, VK_FORMAT_R8G8B8A8_UNORM};
+            return formats[i];
+        }
+        }
+        return VK_FORMAT_UNDEFINED;
+    }
+
+    // write one attribute value of numComponents floats, padding up to numPackedComponents with 1
+    void pack(VertexLayout::Encoding encoding, const float* src, uint32_t numComponents, uint32_t numPackedComponents, uint8_t* dest)
+    {
+        for (uint32_t c = 0; c < numPackedComponents; ++c)
+        {
+            float value = c < numComponents ? src[c] : 1.0f;
+            switch (encoding)
+            {
+            case VertexLayout::Encoding::Float: std::memcpy(dest + c * 4, &value, 4); break;
+            case VertexLayout::Encoding::Half:
+            {
+                uint16_t v = floatToHalf(value);
+                std::memcpy(dest + c * 2, &v, 2);
+                break;
+            }
+            case VertexLayout::Encoding::SNorm16:
+            {
+                int16_t v = normalized<int16_t>(value, -1.0f);
+                std::memcpy(dest + c * 2, &v, 2);
+                break;
+            }
+            case VertexLayout::Encoding::UNorm16:
+            {
+                uint16_t v = normalized<uint16_t>(value, 0.0f);
+                std::memcpy(dest + c * 2, &v, 2);
+                break;
+            }
+            case VertexLayout::Encoding::SNorm8: dest[c] = static_cast<uint8_t>(normalized<int8_t>(value, -1.0f)); break;
+            case VertexLayout::Encoding::UNorm8: dest[c] = normalized<uint8_t>(value, 0.0f); break;
+            }
+        }
+    }
+}
+
+std::vector<uint32_t> vsg::readIndices(const Data* indices)
+{
+    std::vector<uint32_t> values;
+    if (auto ushorts = dynamic_cast<const ushortArray*>(indices)) values.assign(ushorts->begin(), ushorts->end());
+    else if (auto uints = dynamic_cast<const uintArray*>(indices)) values.assign(uints->begin(), uints->end());
+    else if (auto ubytes = dynamic_cast<const ubyteArray*>(indices)) values.assign(ubytes->begin(), ubytes->end());
+    return values;
+}
+
+bool vsg::writeIndices(Data* indices, const std::vector<uint32_t>& values)
+{
+    if (auto ushorts = dynamic_cast<ushortArray*>(indices))
+    {
+        if (ushorts->size() != values.size()) return false;
+        std::transform(values.begin(), values.end(), ushorts->begin(), [](uint32_t i) { return static_cast<uint16_t>(i); });
+    }
+    else if (auto uints = dynamic_cast<uintArray*>(indices))
+    {
+        if (uints->size() != values.size()) return false;
+        std::copy(values.begin(), values.end(), uints->begin());
+    }
+    else if (auto ubytes = dynamic_cast<ubyteArray*>(indices))
+    {
+        if (ubytes->size() != values.size()) return false;
+        std::transform(values.begin(), values.end(), ubytes->begin(), [](uint32_t i) { return static_cast<uint8_t>(i); });
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+double vsg::computeACMR(const std::vector<uint32_t>& indices, uint32_t numVertices, uint32_t cacheSize)
+{
+    std::size_t numTriangles = indices.size() / 3;
+    if (numTriangles == 0) return 0.0;
+
+    // FIFO cache, a vertex is cached if fewer than cacheSize misses have occurred since it was last loaded
+    std::vector<uint64_t> loadedAt(numVertices, 0);
+    uint64_t misses = 0;
+    for (std::size_t i = 0; i < numTriangles * 3; ++i)
+    {
+        uint32_t v = indices[i];
+        if (v >= numVertices) continue;
+        if (loadedAt[v] == 0 || misses - loadedAt[v] >= cacheSize)
+        {
+            ++misses;
+            loadedAt[v] = misses; // stored +1 so 0 means never loaded
+        }
+    }
+    return double(misses) / double(numTriangles);
+}
+
+std::vector<uint32_t> vsg::tipsify(const std::vector<uint32_t>& indices, uint32_t numVertices, uint32_t cacheSize)
+{
+    std::size_t numTriangles = indices.size() / 3;
+    if (numTriangles == 0) return indices;
+
+    for (std::size_t i = 0; i < numTriangles * 3; ++i) numVertices = std::max(numVertices, indices[i] + 1);
+
+    // vertex to triangle adjacency as offsets into one triangle list
+    std::vector<uint32_t> live(numVertices, 0);
+    for (std::size_t i = 0; i < numTriangles * 3; ++i) ++live[indices[i]];
+
+    std::vector<uint32_t> offsets(numVertices + 1, 0);
+    for (uint32_t v = 0; v < numVertices; ++v) offsets[v + 1] = offsets[v] + live[v];
+
+    std::vector<uint32_t> adjacency(offsets[numVertices]);
+    std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+    for (std::size_t t = 0; t < numTriangles; ++t)
+    {
+        for (std::size_t c = 0; c < 3; ++c) adjacency[fill[indices[t * 3 + c]]++] = static_cast<uint32_t>(t);
+    }
+
+    std::vector<uint32_t> result;
+    result.reserve(numTriangles * 3);
+
+    std::vector<uint64_t> cacheTime(numVertices, 0);
+    std::vector<bool> emitted(numTriangles, false);
+    std::vector<uint32_t> deadEnd;
+    std::vector<uint32_t> candidates;
+
+    uint64_t timeStamp = cacheSize + 1;
+    uint32_t cursor = 0;
+    int64_t fanning = 0;
+
+    // skip vertices with no triangles
+    while (cursor < numVertices && live[cursor] == 0) ++cursor;
+    fanning = cursor < numVertices ? cursor : -1;
+
+    while (fanning >= 0)
+    {
+        candidates.clear();
+
+        // emit all the remaining triangles around the fanning vertex
+        for (uint32_t a = offsets[fanning]; a < offsets[fanning + 1]; ++a)
+        {
+            uint32_t t = adjacency[a];
+            if (emitted[t]) continue;
+            emitted[t] = true;
+
+            for (std::size_t c = 0; c < 3; ++c)
+            {
+                uint32_t v = indices[t * 3 + c];
+                result.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                --live[v];
+                if (timeStamp - cacheTime[v] > cacheSize)
+                {
+                    cacheTime[v] = timeStamp;
+                    ++timeStamp;
+                }
+            }
+        }
+
+        // next fanning vertex, the candidate that will still be in the cache after its remaining triangles are emitted, preferring the oldest
+        fanning = -1;
+        uint64_t bestPriority = 0;
+        for (uint32_t v : candidates)
+        {
+            if (live[v] == 0) continue;
+            uint64_t priority = 0;
+            if (timeStamp - cacheTime[v] + 2 * live[v] <= cacheSize) priority = timeStamp - cacheTime[v];
+            if (priority > bestPriority)
+            {
+                bestPriority = priority;
+                fanning = v;
+            }
+        }
+
+        // dead end, fall back to recently used vertices then to the next vertex in input order
+        while (fanning < 0 && !deadEnd.empty())
+        {
+            uint32_t v = deadEnd.back();
+            deadEnd.pop_back();
+            if (live[v] > 0) fanning = v;
+        }
+        while (fanning < 0 && cursor < numVertices)
+        {
+            if (live[cursor] > 0) fanning = cursor;
+            ++cursor;
+        }
+    }
+
+    // keep any trailing indices that don't form a whole triangle
+    result.insert(result.end(), indices.begin() + numTriangles * 3, indices.end());
+    return result;
+}
+
+VertexLayout::VertexLayout(uint32_t in_binding) :
+    binding(in_binding)
+{
+}
+
+bool VertexLayout::add(ref_ptr<Data> array, Encoding encoding)
+{
+    Attribute attribute;
+    if (dynamic_cast<vec2Array*>(array.get())) attribute.numComponents = 2;
+    else if (dynamic_cast<vec3Array*>(array.get())) attribute.numComponents = 3;
+    else if (dynamic_cast<vec4Array*>(array.get())) attribute.numComponents = 4;
+    else
+    {
+        std::cout << "Warning: VertexLayout::add() only supports vec2Array, vec3Array and vec4Array." << std::endl;
+        return false;
+    }
+
+    uint32_t count = static_cast<uint32_t>(array->valueCount());
+    if (!_attributes.empty() && count != _numVertices)
+    {
+        std::cout << "Warning: VertexLayout::add() array has " << count << " vertices, expected " << _numVertices << std::endl;
+        return false;
+    }
+    _numVertices = count;
+
+    attribute.array = array;
+    attribute.encoding = encoding;
+    attribute.numPackedComponents = (attribute.numComponents == 3 && componentSize(encoding) < 4) ? 4 : attribute.numComponents;
+    attribute.format = format(encoding, attribute.numPackedComponents);
+
+    // keep every attribute 4 byte aligned
+    attribute.offset = _stride;
+    _stride += (attribute.numPackedComponents * componentSize(encoding) + 3) & ~3u;
+
+    _attributes.push_back(attribute);
+    return true;
+}
+
+ref_ptr<ubyteArray> VertexLayout::interleave()
+{
+    auto buffer = ubyteArray::create(_numVertices * _stride);
+    auto dest = static_cast<uint8_t*>(buffer->dataPointer());
+    std::memset(dest, 0, buffer->dataSize());
+
+    separateSize = 0;
+    for (auto& attribute : _attributes)
+    {
+        separateSize += attribute.array->dataSize();
+
+        auto src = static_cast<const float*>(attribute.array->dataPointer());
+        for (uint32_t i = 0; i < _numVertices; ++i)
+        {
+            pack(attribute.encoding, src + i * attribute.numComponents, attribute.numComponents, attribute.numPackedComponents, dest + i * _stride + attribute.offset);
+        }
+    }
+    interleavedSize = buffer->dataSize();
+
+    return buffer;
+}
+
+VkVertexInputBindingDescription VertexLayout::bindingDescription(VkVertexInputRate inputRate) const
+{
+    return VkVertexInputBindingDescription{binding, _stride, inputRate};
+}
+
+VertexInputState::Attributes VertexLayout::attributeDescriptions(uint32_t firstLocation) const
+{
+    VertexInputState::Attributes descriptions;
+    for (auto& attribute : _attributes)
+    {
+        descriptions.push_back(VkVertexInputAttributeDescription{firstLocation++, binding, attribute.format, attribute.offset});
+    }
+    return descriptions;
+}
+
+bool VertexLayout::optimize(Data* indices)
+{
+    auto values = readIndices(indices);
+    if (values.empty()) return false;
+
+    acmrBefore = computeACMR(values, _numVertices, cacheSize);
+    values = tipsify(values, _numVertices, cacheSize);
+    acmrAfter = computeACMR(values, _numVertices, cacheSize);
+
+    return writeIndices(indices, values);
+}
+
+void VertexLayout::report(std::ostream& out) const
+{
+    out << "VertexLayout " << _numVertices << " vertices, " << _attributes.size() << " attributes, stride " << _stride << std::endl;
+    out << "    vertex data " << separateSize << " bytes in separate arrays, " << interleavedSize << " bytes interleaved" << std::endl;
+    out << "    ACMR with " << cacheSize << " entry cache " << acmrBefore << " before, " << acmrAfter << " after reordering" << std::endl;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <vsg/all.h>
+
+#include <ostream>
+#include <vector>
+
+namespace vsg
+{
+
+    // index reordering and post transform vertex cache simulation for triangle lists, the indices are read as 32 bit values
+    // from a ushortArray, uintArray or ubyteArray
+
+    // indices as a uint32_t vector, empty if indices isn't an index array
+    std::vector<uint32_t> readIndices(const Data* indices);
+
+    // copy values back into the ushortArray, uintArray or ubyteArray, values must be the same size as indices
+    bool writeIndices(Data* indices, const std::vector<uint32_t>& values);
+
+    // average cache miss ratio, the number of vertices transformed per triangle with a FIFO cache of cacheSize entries.
+    // 0.5 is ideal for a regular mesh, 3.0 is the worst case.
+    double computeACMR(const std::vector<uint32_t>& indices, uint32_t numVertices, uint32_t cacheSize = 16);
+
+    // reorder triangles for the post transform vertex cache using Tipsify (Sander, Nehab & Barczak 2007), linear in the number
+    // of triangles. The winding of each triangle is preserved.
+    std::vector<uint32_t> tipsify(const std::vector<uint32_t>& indices, uint32_t numVertices, uint32_t cacheSize = 16);
+
+    //
+    // VertexLayout interleaves per vertex vec2Array, vec3Array and vec4Array data into a single stride packed buffer bound
+    // as one vertex binding, optionally quantising attributes to half floats or normalized integers, and reorders indices for
+    // the post transform vertex cache. Attributes are read by the vertex shader at consecutive locations in the order added.
+    //
+    // Three component attributes quantised to 8 or 16 bits are padded to four components, with the padding set to 1, as
+    // three component 8 and 16 bit vertex formats are not widely supported.
+    //
+    class VertexLayout : public Inherit<Object, VertexLayout>
+    {
+    public:
+        enum class Encoding
+        {
+            Float,   // 32 bit float, unchanged
+            Half,    // 16 bit float, positions and tex coords
+            SNorm16, // values in -1 to 1, normals and tangents
+            SNorm8,
+            UNorm16, // values in 0 to 1, colours and weights
+            UNorm8
+        };
+
+        struct Attribute
+        {
+            ref_ptr<Data> array;
+            Encoding encoding = Encoding::Float;
+            uint32_t numComponents = 0; // in the source array
+            uint32_t numPackedComponents = 0;
+            uint32_t offset = 0;
+            VkFormat format = VK_FORMAT_UNDEFINED;
+        };
+
+        explicit VertexLayout(uint32_t in_binding = 0);
+
+        uint32_t binding = 0;
+        uint32_t cacheSize = 16;
+
+        // add a vec2Array, vec3Array or vec4Array, all arrays must have the same number of vertices. Returns false for unsupported arrays.
+        bool add(ref_ptr<Data> array, Encoding encoding = Encoding::Float);
+
+        const std::vector<Attribute>& getAttributes() const { return _attributes; }
+        uint32_t stride() const { return _stride; }
+        uint32_t numVertices() const { return _numVertices; }
+
+        // the interleaved vertex data, numVertices() * stride() bytes
+        ref_ptr<ubyteArray> interleave();
+
+        VkVertexInputBindingDescription bindingDescription(VkVertexInputRate inputRate = VK_VERTEX_INPUT_RATE_VERTEX) const;
+        VertexInputState::Attributes attributeDescriptions(uint32_t firstLocation = 0) const;
+
+        // reorder the triangles of a ushortArray or uintArray index list in place, returns false if indices isn't an index array
+        bool optimize(Data* indices);
+
+        void report(std::ostream& out) const;
+
+        // stats, sizes in bytes
+        std::size_t separateSize = 0;
+        std::size_t interleavedSize = 0;
+        double acmrBefore = 0.0;
+        double acmrAfter = 0.0;
+
+    protected:
+        std::vector<Attribute> _attributes;
+        uint32_t _stride = 0;
+        uint32_t _numVertices = 0;
+    };
+    VSG_type_name(VertexLayout)
+
+} // namespace vsg
@@ -0,0 +1,127 @@
+#include "ComputeStream.h"
+
+#include <chrono>
+#include <iostream>
+
+using namespace vsg;
+
+namespace
+{
+    template<typename F>
+    double time(F function)
+    {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        return std::chrono::duration<double, std::chrono::milliseconds::period>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+ComputeStream::ComputeStream(Device* device, uint32_t queueFamily) :
+    _device(device),
+    _queue(device->getQueue(queueFamily)),
+    _commandPool(CommandPool::create(device, queueFamily, VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT))
+{
+    // each slot's command buffer is re-recorded every frame, so the pool must allow them to be reset individually
+}
+
+ComputeStream::~ComputeStream()
+{
+    for (auto& slot : _slots)
+    {
+        if (slot.frame >= 0) wait(slot);
+    }
+}
+
+void ComputeStream::addSlot(ref_ptr<Node> commands)
+{
+    Slot slot;
+    slot.commands = commands;
+    slot.commandBuffer = CommandBuffer::create(_device, _commandPool, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+    slot.fence = Fence::create(_device);
+    _slots.push_back(slot);
+}
+
+void ComputeStream::submit(Slot& slot)
+{
+    // commands are re-recorded for every frame so that prepare callbacks can update any state they depend on
+    VkCommandBufferBeginInfo beginInfo = {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    vkBeginCommandBuffer(*slot.commandBuffer, &beginInfo);
+
+    RecordTraversal recordTraversal(slot.commandBuffer);
+    slot.commands->accept(recordTraversal);
+
+    vkEndCommandBuffer(*slot.commandBuffer);
+
+    VkCommandBuffer commandBuffer = *slot.commandBuffer;
+
+    VkSubmitInfo submitInfo = {};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &commandBuffer;
+    if (_queue->submit(submitInfo, slot.fence) != VK_SUCCESS)
+    {
+        std::cout << "Warning: ComputeStream unable to submit frame " << slot.frame << std::endl;
+    }
+}
+
+void ComputeStream::wait(Slot& slot)
+{
+    VkFence fence = *slot.fence;
+    waitTime += time([&]() {
+        vkWaitForFences(*_device, 1, &fence, VK_TRUE, 100000000000);
+    });
+    vkResetFences(*_device, 1, &fence);
+}
+
+void ComputeStream::run(uint32_t frameCount, FrameCallback prepare, FrameCallback complete)
+{
+    if (_slots.empty()) return;
+
+    uint32_t slotCount = numSlots();
+
+    auto finish = [&](uint32_t index) {
+        auto& slot = _slots[index];
+        if (slot.frame < 0) return;
+
+        wait(slot);
+        if (complete)
+        {
+            completeTime += time([&]() { complete(static_cast<uint32_t>(slot.frame), index); });
+        }
+        slot.frame = -1;
+    };
+
+    totalTime += time([&]() {
+        for (uint32_t frame = 0; frame < frameCount; ++frame)
+        {
+            // reuse the oldest slot, the frames submitted after it keep the GPU busy while its results are processed
+            uint32_t index = frame % slotCount;
+            finish(index);
+
+            if (prepare) prepare(frame, index);
+
+            _slots[index].frame = frame;
+            submit(_slots[index]);
+        }
+
+        // drain the remaining frames in the order they were submitted
+        for (uint32_t i = 0; i < slotCount; ++i)
+        {
+            finish((frameCount + i) % slotCount);
+        }
+    });
+
+    numFrames += frameCount;
+}
+
+void ComputeStream::report(std::ostream& out) const
+{
+    out << "ComputeStream numSlots = " << _slots.size() << ", numFrames = " << numFrames << ", sustained " << framesPerSecond() << " frames/s" << std::endl;
+    if (numFrames > 0)
+    {
+        out << "    total time " << totalTime << "ms, " << totalTime / double(numFrames) << "ms/frame" << std::endl;
+        out << "    waiting on GPU " << waitTime / double(numFrames) << "ms/frame, readback and write " << completeTime / double(numFrames) << "ms/frame" << std::endl;
+    }
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <vsg/all.h>
+
+#include <functional>
+#include <ostream>
+
+namespace vsg
+{
+
+    //
+    // ComputeStream runs a sequence of frames through a small ring of slots, each slot with its own compiled commands,
+    // command buffer and fence, so that the GPU works on the next frames while the CPU reads back and writes out earlier ones.
+    // Two slots gives double buffering, three triple buffering.
+    //
+    class ComputeStream : public Inherit<Object, ComputeStream>
+    {
+    public:
+        ComputeStream(Device* device, uint32_t queueFamily);
+
+        // add the compiled commands for a slot, typically one slot per set of output buffers
+        void addSlot(ref_ptr<Node> commands);
+
+        uint32_t numSlots() const { return static_cast<uint32_t>(_slots.size()); }
+
+        using FrameCallback = std::function<void(uint32_t frame, uint32_t slot)>;
+
+        // process numFrames frames, prepare is called before the slot's commands are recorded and complete once they have finished executing.
+        void run(uint32_t numFrames, FrameCallback prepare, FrameCallback complete);
+
+        void report(std::ostream& out) const;
+
+        // stats, times in milliseconds
+        uint32_t numFrames = 0;
+        double totalTime = 0.0;
+        double waitTime = 0.0;
+        double completeTime = 0.0;
+
+        double framesPerSecond() const { return totalTime > 0.0 ? double(numFrames) * 1000.0 / totalTime : 0.0; }
+
+    protected:
+        virtual ~ComputeStream();
+
+        struct Slot
+        {
+            ref_ptr<Node> commands;
+            ref_ptr<CommandBuffer> commandBuffer;
+            ref_ptr<Fence> fence;
+            int64_t frame = -1;
+        };
+
+        void submit(Slot& slot);
+        void wait(Slot& slot);
+
+        ref_ptr<Device> _device;
+        ref_ptr<Queue> _queue;
+        ref_ptr<CommandPool> _commandPool;
+
+        std::vector<Slot> _slots;
+    };
+    VSG_type_name(ComputeStream)
+
+}
@@ -0,0 +1,304 @@
+#include "DeviceMemoryPool.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+using namespace vsg;
+
+namespace
+{
+    VkDeviceSize nextPowerOfTwo(VkDeviceSize size)
+    {
+        VkDeviceSize value = 1;
+        while (value < size) value <<= 1;
+        return value;
+    }
+}
+
+DeviceMemoryPool::DeviceMemoryPool(Device* device, VkDeviceSize blockSize, VkDeviceSize minAllocationSize) :
+    _device(device),
+    _blockSize(nextPowerOfTwo(blockSize)),
+    _minAllocationSize(nextPowerOfTwo(minAllocationSize))
+{
+    auto physicalDevice = device->getPhysicalDevice();
+    vkGetPhysicalDeviceMemoryProperties(*physicalDevice, &_memoryProperties);
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(*physicalDevice, &properties);
+    _bufferImageGranularity = properties.limits.bufferImageGranularity;
+
+    _maxOrder = orderOf(_blockSize);
+
+    // the heap budgets are only available when the physical device supports VK_EXT_memory_budget and vkGetPhysicalDeviceMemoryProperties2
+    // is available, either from a Vulkan 1.1 instance or VK_KHR_get_physical_device_properties2.
+    uint32_t extensionCount = 0;
+    vkEnumerateDeviceExtensionProperties(*physicalDevice, nullptr, &extensionCount, nullptr);
+    std::vector<VkExtensionProperties> extensions(extensionCount);
+    vkEnumerateDeviceExtensionProperties(*physicalDevice, nullptr, &extensionCount, extensions.data());
+
+    bool memoryBudgetSupported = std::any_of(extensions.begin(), extensions.end(), [](const VkExtensionProperties& extension) { return std::strcmp(extension.extensionName, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) == 0; });
+    if (memoryBudgetSupported)
+    {
+        VkInstance instance = *(physicalDevice->getInstance());
+        _vkGetPhysicalDeviceMemoryProperties2 = reinterpret_cast<PFN_vkGetPhysicalDeviceMemoryProperties2>(vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceMemoryProperties2"));
+        if (!_vkGetPhysicalDeviceMemoryProperties2)
+        {
+            _vkGetPhysicalDeviceMemoryProperties2 = reinterpret_cast<PFN_vkGetPhysicalDeviceMemoryProperties2>(vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceMemoryProperties2KHR"));
+        }
+    }
+}
+
+bool DeviceMemoryPool::queryBudget(std::vector<VkDeviceSize>& budgets, std::vector<VkDeviceSize>& usages) const
+{
+    if (!_vkGetPhysicalDeviceMemoryProperties2) return false;
+
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties = {};
+    budgetProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+
+    VkPhysicalDeviceMemoryProperties2 memoryProperties = {};
+    memoryProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+    memoryProperties.pNext = &budgetProperties;
+
+    _vkGetPhysicalDeviceMemoryProperties2(*(_device->getPhysicalDevice()), &memoryProperties);
+
+    budgets.assign(budgetProperties.heapBudget, budgetProperties.heapBudget + _memoryProperties.memoryHeapCount);
+    usages.assign(budgetProperties.heapUsage, budgetProperties.heapUsage + _memoryProperties.memoryHeapCount);
+    return true;
+}
+
+uint32_t DeviceMemoryPool::findMemoryType(uint32_t memoryTypeBits, VkMemoryPropertyFlags properties) const
+{
+    for (uint32_t i = 0; i < _memoryProperties.memoryTypeCount; ++i)
+    {
+        if ((memoryTypeBits & (1 << i)) && (_memoryProperties.memoryTypes[i].propertyFlags & properties) == properties) return i;
+    }
+    return VK_MAX_MEMORY_TYPES;
+}
+
+uint32_t DeviceMemoryPool::orderOf(VkDeviceSize size) const
+{
+    uint32_t order = 0;
+    VkDeviceSize orderSize = _minAllocationSize;
+    while (orderSize < size)
+    {
+        orderSize <<= 1;
+        ++order;
+    }
+    return order;
+}
+
+DeviceMemoryPool::Block* DeviceMemoryPool::createBlock(uint32_t memoryTypeIndex, VkDeviceSize size, bool dedicated)
+{
+    // respect the heap budget, which accounts for the memory used by the rest of the application and other processes,
+    // falling back to the heap size as the limit for the DeviceMemory we allocate from it when the budget isn't available
+    uint32_t heapIndex = _memoryProperties.memoryTypes[memoryTypeIndex].heapIndex;
+
+    std::vector<VkDeviceSize> budgets, usages;
+    VkDeviceSize heapLimit = _memoryProperties.memoryHeaps[heapIndex].size;
+    VkDeviceSize heapUsage = 0;
+    if (queryBudget(budgets, usages))
+    {
+        heapLimit = budgets[heapIndex];
+        heapUsage = usages[heapIndex];
+    }
+    else
+    {
+        for (auto& block : _blocks)
+        {
+            if (_memoryProperties.memoryTypes[block->memoryTypeIndex].heapIndex == heapIndex) heapUsage += block->size;
+        }
+    }
+
+    if (heapUsage + size > heapLimit)
+    {
+        std::cout << "Warning: DeviceMemoryPool heap " << heapIndex << " budget exceeded, unable to allocate " << size << " bytes." << std::endl;
+        return nullptr;
+    }
+
+    VkMemoryRequirements blockRequirements;
+    blockRequirements.size = size;
+    blockRequirements.alignment = 1;
+    blockRequirements.memoryTypeBits = 1 << memoryTypeIndex;
+
+    auto memory = DeviceMemory::create(_device, blockRequirements, _memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags);
+    if (!memory) return nullptr;
+
+    auto block = std::make_unique<Block>();
+    block->memory = memory;
+    block->memoryTypeIndex = memoryTypeIndex;
+    block->size = size;
+    block->dedicated = dedicated;
+    if (!dedicated)
+    {
+        block->freeLists.resize(_maxOrder + 1);
+        block->freeLists[_maxOrder].insert(0);
+    }
+
+    _blocks.push_back(std::move(block));
+    return _blocks.back().get();
+}
+
+bool DeviceMemoryPool::allocate(Block& block, uint32_t order, VkDeviceSize& offset)
+{
+    // find the smallest free range that fits
+    uint32_t available = order;
+    while (available <= _maxOrder && block.freeLists[available].empty()) ++available;
+    if (available > _maxOrder) return false;
+
+    offset = *block.freeLists[available].begin();
+    block.freeLists[available].erase(block.freeLists[available].begin());
+
+    // split down to the required order, returning the upper halves to the free lists
+    while (available > order)
+    {
+        --available;
+        block.freeLists[available].insert(offset + (_minAllocationSize << available));
+    }
+
+    block.allocations[offset] = order;
+    block.used += (_minAllocationSize << order);
+    return true;
+}
+
+DeviceMemoryPool::MemoryOffset DeviceMemoryPool::reserve(const VkMemoryRequirements& memRequirements, VkMemoryPropertyFlags properties, bool linear)
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+
+    uint32_t memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
+    if (memoryTypeIndex == VK_MAX_MEMORY_TYPES) return {};
+
+    // buddy offsets are aligned to their size, so allocating at least the alignment size satisfies the alignment.
+    // Rounding images up to bufferImageGranularity gives them whole granularity pages, so buffers and images never share a page.
+    VkDeviceSize size = std::max(memRequirements.size, memRequirements.alignment);
+    if (!linear) size = std::max(size, _bufferImageGranularity);
+    if (size > _blockSize)
+    {
+        Block* block = createBlock(memoryTypeIndex, memRequirements.size, true);
+        if (!block) return {};
+
+        block->used = block->size;
+        block->allocations[0] = 0;
+        return {block->memory, 0};
+    }
+
+    uint32_t order = orderOf(size);
+    VkDeviceSize offset = 0;
+    for (auto& block : _blocks)
+    {
+        if (block->dedicated || block->memoryTypeIndex != memoryTypeIndex) continue;
+        if (allocate(*block, order, offset)) return {block->memory, offset};
+    }
+
+    Block* block = createBlock(memoryTypeIndex, _blockSize, false);
+    if (block && allocate(*block, order, offset)) return {block->memory, offset};
+
+    return {};
+}
+
+DeviceMemoryPool::MemoryOffset DeviceMemoryPool::bind(Buffer* buffer, VkMemoryPropertyFlags properties)
+{
+    VkMemoryRequirements memRequirements;
+    vkGetBufferMemoryRequirements(*_device, *buffer, &memRequirements);
+
+    auto memoryOffset = reserve(memRequirements, properties);
+    if (memoryOffset.first) buffer->bind(memoryOffset.first, memoryOffset.second);
+    return memoryOffset;
+}
+
+DeviceMemoryPool::MemoryOffset DeviceMemoryPool::bind(Image* image, VkMemoryPropertyFlags properties)
+{
+    VkMemoryRequirements memRequirements;
+    vkGetImageMemoryRequirements(*_device, *image, &memRequirements);
+
+    // treat all images as optimally tiled, linear images are rare and only lose the rounding up to bufferImageGranularity
+    auto memoryOffset = reserve(memRequirements, properties, false);
+    if (memoryOffset.first) image->bind(memoryOffset.first, memoryOffset.second);
+    return memoryOffset;
+}
+
+void DeviceMemoryPool::release(DeviceMemory* memory, VkDeviceSize offset)
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+
+    auto block_itr = std::find_if(_blocks.begin(), _blocks.end(), [&](const std::unique_ptr<Block>& block) { return block->memory == memory; });
+    if (block_itr == _blocks.end()) return;
+
+    Block& block = **block_itr;
+    if (block.dedicated)
+    {
+        _blocks.erase(block_itr);
+        return;
+    }
+
+    auto itr = block.allocations.find(offset);
+    if (itr == block.allocations.end()) return;
+
+    uint32_t order = itr->second;
+    block.allocations.erase(itr);
+    block.used -= (_minAllocationSize << order);
+
+    // merge with the buddy for as long as it's free
+    while (order < _maxOrder)
+    {
+        VkDeviceSize buddy = offset ^ (_minAllocationSize << order);
+        auto buddy_itr = block.freeLists[order].find(buddy);
+        if (buddy_itr == block.freeLists[order].end()) break;
+
+        block.freeLists[order].erase(buddy_itr);
+        offset = std::min(offset, buddy);
+        ++order;
+    }
+
+    block.freeLists[order].insert(offset);
+}
+
+DeviceMemoryPool::Stats DeviceMemoryPool::getStats() const
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+
+    Stats stats;
+    std::vector<VkDeviceSize> budgets, usages;
+    bool budgetAvailable = queryBudget(budgets, usages);
+
+    stats.heaps.resize(_memoryProperties.memoryHeapCount);
+    for (uint32_t i = 0; i < _memoryProperties.memoryHeapCount; ++i)
+    {
+        stats.heaps[i].heapSize = _memoryProperties.memoryHeaps[i].size;
+        stats.heaps[i].budget = budgetAvailable ? budgets[i] : stats.heaps[i].heapSize;
+        if (budgetAvailable) stats.heaps[i].usage = usages[i];
+    }
+
+    for (auto& block : _blocks)
+    {
+        ++stats.numBlocks;
+        stats.numAllocations += static_cast<uint32_t>(block->allocations.size());
+        stats.allocated += block->size;
+        stats.used += block->used;
+
+        for (uint32_t order = 0; order < block->freeLists.size(); ++order)
+        {
+            if (!block->freeLists[order].empty()) stats.largestFree = std::max(stats.largestFree, _minAllocationSize << order);
+        }
+
+        auto& heap = stats.heaps[_memoryProperties.memoryTypes[block->memoryTypeIndex].heapIndex];
+        heap.allocated += block->size;
+        heap.used += block->used;
+        if (!budgetAvailable) heap.usage += block->size;
+    }
+
+    return stats;
+}
+
+void DeviceMemoryPool::report(std::ostream& out) const
+{
+    auto stats = getStats();
+
+    out << "DeviceMemoryPool numBlocks = " << stats.numBlocks << ", numAllocations = " << stats.numAllocations << ", allocated = " << stats.allocated << ", used = " << stats.used << ", fragmentation = " << stats.fragmentation() << std::endl;
+    for (size_t i = 0; i < stats.heaps.size(); ++i)
+    {
+        auto& heap = stats.heaps[i];
+        if (heap.allocated == 0) continue;
+        out << "    heap " << i << " size = " << heap.heapSize << ", budget = " << heap.budget << ", usage = " << heap.usage << ", allocated = " << heap.allocated << ", used = " << heap.used << std::endl;
+    }
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <vsg/all.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <set>
+
+namespace vsg
+{
+
+    //
+    // DeviceMemoryPool sub-allocates Buffer and Image memory from large DeviceMemory blocks using a buddy allocator,
+    // so that many resources share a small number of vkAllocateMemory calls.
+    // Requests larger than the block size get their own dedicated DeviceMemory.
+    // Images are rounded up to bufferImageGranularity so they never share a granularity page with a buffer in the same block.
+    //
+    class DeviceMemoryPool : public Inherit<Object, DeviceMemoryPool>
+    {
+    public:
+        DeviceMemoryPool(Device* device, VkDeviceSize blockSize = 64 * 1024 * 1024, VkDeviceSize minAllocationSize = 256);
+
+        using MemoryOffset = std::pair<ref_ptr<DeviceMemory>, VkDeviceSize>;
+
+        // reserve memory that meets the requirements, linear is false for optimally tiled images, returns {nullptr, 0} on failure.
+        MemoryOffset reserve(const VkMemoryRequirements& memRequirements, VkMemoryPropertyFlags properties, bool linear = true);
+
+        // convenience methods that reserve and then bind memory to a Buffer/Image, returns {nullptr, 0} on failure.
+        MemoryOffset bind(Buffer* buffer, VkMemoryPropertyFlags properties);
+        MemoryOffset bind(Image* image, VkMemoryPropertyFlags properties);
+
+        // return a reservation to the pool
+        void release(DeviceMemory* memory, VkDeviceSize offset);
+
+        struct HeapStats
+        {
+            VkDeviceSize heapSize = 0;  // size of the heap
+            VkDeviceSize budget = 0;    // VK_EXT_memory_budget heapBudget for this process, heapSize when the extension isn't supported
+            VkDeviceSize usage = 0;     // VK_EXT_memory_budget heapUsage by this process, allocated when the extension isn't supported
+            VkDeviceSize allocated = 0; // DeviceMemory allocated from the heap by the pool
+            VkDeviceSize used = 0;      // reserved by Buffer/Image
+        };
+
+        struct Stats
+        {
+            uint32_t numBlocks = 0;
+            uint32_t numAllocations = 0;
+            VkDeviceSize allocated = 0;
+            VkDeviceSize used = 0;
+            VkDeviceSize largestFree = 0;
+
+            // 0.0 when all the free space is in one contiguous range, approaching 1.0 when it's scattered
+            double fragmentation() const { VkDeviceSize free = allocated - used; return free > 0 ? 1.0 - double(largestFree) / double(free) : 0.0; }
+
+            std::vector<HeapStats> heaps;
+        };
+
+        Stats getStats() const;
+
+        void report(std::ostream& out) const;
+
+    protected:
+        struct Block
+        {
+            ref_ptr<DeviceMemory> memory;
+            uint32_t memoryTypeIndex = 0;
+            VkDeviceSize size = 0;
+            VkDeviceSize used = 0;
+            bool dedicated = false;
+
+            // free offsets for each order, order 0 is minAllocationSize
+            std::vector<std::set<VkDeviceSize>> freeLists;
+            std::map<VkDeviceSize, uint32_t> allocations; // offset, order
+        };
+
+        uint32_t findMemoryType(uint32_t memoryTypeBits, VkMemoryPropertyFlags properties) const;
+        bool queryBudget(std::vector<VkDeviceSize>& budgets, std::vector<VkDeviceSize>& usages) const;
+        uint32_t orderOf(VkDeviceSize size) const;
+        bool allocate(Block& block, uint32_t order, VkDeviceSize& offset);
+        Block* createBlock(uint32_t memoryTypeIndex, VkDeviceSize size, bool dedicated);
+
+        mutable std::mutex _mutex;
+        ref_ptr<Device> _device;
+        VkPhysicalDeviceMemoryProperties _memoryProperties;
+        VkDeviceSize _bufferImageGranularity;
+        PFN_vkGetPhysicalDeviceMemoryProperties2 _vkGetPhysicalDeviceMemoryProperties2 = nullptr;
+        VkDeviceSize _blockSize;
+        VkDeviceSize _minAllocationSize;
+        uint32_t _maxOrder;
+
+        std::vector<std::unique_ptr<Block>> _blocks;
+    };
+    VSG_type_name(DeviceMemoryPool)
+
+}
@@ -0,0 +1,36 @@
+#include "QueryPool.h"
+
+#include <iostream>
+
+using namespace vsg;
+
+QueryPool::QueryPool(Device* device, VkQueryType queryType, uint32_t queryCount) :
+    _device(device),
+    _queryCount(queryCount)
+{
+    VkQueryPoolCreateInfo createInfo = {};
+    createInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    createInfo.queryType = queryType;
+    createInfo.queryCount = queryCount;
+
+    if (vkCreateQueryPool(*device, &createInfo, nullptr, &_queryPool) != VK_SUCCESS)
+    {
+        std::cout << "Warning: unable to create VkQueryPool." << std::endl;
+        _queryPool = VK_NULL_HANDLE;
+    }
+}
+
+QueryPool::~QueryPool()
+{
+    if (_queryPool) vkDestroyQueryPool(*_device, _queryPool, nullptr);
+}
+
+std::vector<uint64_t> QueryPool::getResults(uint32_t firstQuery, uint32_t count) const
+{
+    std::vector<uint64_t> results(count, 0);
+    if (_queryPool)
+    {
+        vkGetQueryPoolResults(*_device, _queryPool, firstQuery, count, count * sizeof(uint64_t), results.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+    }
+    return results;
+}
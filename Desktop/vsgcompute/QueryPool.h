@@ -0,0 +1,80 @@
+#pragma once
+
+#include <vsg/all.h>
+
+#include <vector>
+
+namespace vsg
+{
+
+    //
+    // QueryPool wraps a VkQueryPool, used here for timing GPU work with timestamp queries.
+    //
+    class QueryPool : public Inherit<Object, QueryPool>
+    {
+    public:
+        QueryPool(Device* device, VkQueryType queryType, uint32_t queryCount);
+
+        operator VkQueryPool() const { return _queryPool; }
+
+        uint32_t queryCount() const { return _queryCount; }
+
+        // wait for and return the 64 bit results of queries [firstQuery, firstQuery+count)
+        std::vector<uint64_t> getResults(uint32_t firstQuery, uint32_t count) const;
+
+    protected:
+        virtual ~QueryPool();
+
+        ref_ptr<Device> _device;
+        VkQueryPool _queryPool = VK_NULL_HANDLE;
+        uint32_t _queryCount = 0;
+    };
+    VSG_type_name(QueryPool)
+
+    //
+    // ResetQueryPool command, must be recorded before the queries are written
+    //
+    class ResetQueryPool : public Inherit<Command, ResetQueryPool>
+    {
+    public:
+        ResetQueryPool(QueryPool* queryPool, uint32_t firstQuery, uint32_t queryCount) :
+            _queryPool(queryPool),
+            _firstQuery(firstQuery),
+            _queryCount(queryCount) {}
+
+        void dispatch(CommandBuffer& commandBuffer) const override
+        {
+            vkCmdResetQueryPool(commandBuffer, *_queryPool, _firstQuery, _queryCount);
+        }
+
+    protected:
+        ref_ptr<QueryPool> _queryPool;
+        uint32_t _firstQuery;
+        uint32_t _queryCount;
+    };
+    VSG_type_name(ResetQueryPool)
+
+    //
+    // WriteTimestamp command, writes the GPU timestamp once all prior commands have reached the specified pipeline stage
+    //
+    class WriteTimestamp : public Inherit<Command, WriteTimestamp>
+    {
+    public:
+        WriteTimestamp(QueryPool* queryPool, uint32_t query, VkPipelineStageFlagBits pipelineStage) :
+            _queryPool(queryPool),
+            _query(query),
+            _pipelineStage(pipelineStage) {}
+
+        void dispatch(CommandBuffer& commandBuffer) const override
+        {
+            vkCmdWriteTimestamp(commandBuffer, _pipelineStage, *_queryPool, _query);
+        }
+
+    protected:
+        ref_ptr<QueryPool> _queryPool;
+        uint32_t _query;
+        VkPipelineStageFlagBits _pipelineStage;
+    };
+    VSG_type_name(WriteTimestamp)
+
+}
@@ -1,7 +1,390 @@
 #include <vsg/all.h>
 
+#include "ComputeBarrier.h"
+#include "ComputeStream.h"
+#include "DeviceMemoryPool.h"
+#include "QueryPool.h"
+
+#include <algorithm>
 #include <iostream>
+#include <iomanip>
 #include <chrono>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+// create the StateGroup that binds the compute pipeline and output storage buffer, the Dispatch commands are added by the caller.
+// When tiled the width and height are the tile's dimensions, and the tile's origin and image dimensions are passed to the shader as a vec4 push constant.
+vsg::ref_ptr<vsg::StateGroup> createComputeGraph(const vsg::Paths& searchPaths, vsg::Buffer* buffer, VkDeviceSize bufferSize, int width, int height, int workgroupSize, bool tiled = false)
+{
+    vsg::ref_ptr<vsg::ShaderStage> computeStage = vsg::ShaderStage::read(VK_SHADER_STAGE_COMPUTE_BIT, "main", vsg::findFile(tiled ? "shaders/tile.spv" : "shaders/comp.spv", searchPaths));
+    if (!computeStage) return {};
+
+    computeStage->setSpecializationConstants({
+        {0, vsg::intValue::create(width)},
+        {1, vsg::intValue::create(height)},
+        {2, vsg::intValue::create(workgroupSize)}
+    });
+
+    // set up DescriptorSetLayout, DecriptorSet and BindDescriptorSets
+    vsg::DescriptorSetLayoutBindings descriptorBindings { {0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr} };
+    auto descriptorSetLayout = vsg::DescriptorSetLayout::create(descriptorBindings);
+    vsg::Descriptors descriptors { vsg::DescriptorBuffer::create(vsg::BufferDataList{vsg::BufferData(buffer, 0, bufferSize)}, 0, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER) };
+
+    auto descriptorSet = vsg::DescriptorSet::create(descriptorSetLayout, descriptors);
+    vsg::PushConstantRanges pushConstantRanges;
+    if (tiled) pushConstantRanges.push_back(VkPushConstantRange{VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(vsg::vec4)});
+
+    auto pipelineLayout = vsg::PipelineLayout::create(vsg::DescriptorSetLayouts{descriptorSetLayout}, pushConstantRanges);
+    auto bindDescriptorSet = vsg::BindDescriptorSet::create(VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, descriptorSet);
+
+    // set up the compute pipeline
+    auto pipeline = vsg::ComputePipeline::create(pipelineLayout, computeStage);
+    auto bindPipeline = vsg::BindComputePipeline::create(pipeline);
+
+    // assign to a CommandGraph that binds the Pipeline and DescritorSets
+    auto commandGraph = vsg::StateGroup::create();
+    commandGraph->add(bindPipeline);
+    commandGraph->add(bindDescriptorSet);
+    return commandGraph;
+}
+
+// create the StateGroup that binds the pipeline packing the float RGBA outputBuffer into the R8G8B8A8_UNORM packedBuffer.
+vsg::ref_ptr<vsg::StateGroup> createPackGraph(const vsg::Path& shaderFilename, vsg::Buffer* inputBuffer, VkDeviceSize inputSize, vsg::Buffer* packedBuffer, VkDeviceSize packedSize, int width, int height, int workgroupSize)
+{
+    vsg::ref_ptr<vsg::ShaderStage> packStage = vsg::ShaderStage::read(VK_SHADER_STAGE_COMPUTE_BIT, "main", shaderFilename);
+    if (!packStage) return {};
+
+    packStage->setSpecializationConstants({
+        {0, vsg::intValue::create(width)},
+        {1, vsg::intValue::create(height)},
+        {2, vsg::intValue::create(workgroupSize)}
+    });
+
+    vsg::DescriptorSetLayoutBindings descriptorBindings {
+        {0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr},
+        {1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr}
+    };
+    auto descriptorSetLayout = vsg::DescriptorSetLayout::create(descriptorBindings);
+    vsg::Descriptors descriptors {
+        vsg::DescriptorBuffer::create(vsg::BufferDataList{vsg::BufferData(inputBuffer, 0, inputSize)}, 0, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER),
+        vsg::DescriptorBuffer::create(vsg::BufferDataList{vsg::BufferData(packedBuffer, 0, packedSize)}, 1, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
+    };
+
+    auto descriptorSet = vsg::DescriptorSet::create(descriptorSetLayout, descriptors);
+    auto pipelineLayout = vsg::PipelineLayout::create(vsg::DescriptorSetLayouts{descriptorSetLayout}, vsg::PushConstantRanges{});
+    auto bindDescriptorSet = vsg::BindDescriptorSet::create(VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, descriptorSet);
+
+    auto pipeline = vsg::ComputePipeline::create(pipelineLayout, packStage);
+    auto bindPipeline = vsg::BindComputePipeline::create(pipeline);
+
+    auto packGraph = vsg::StateGroup::create();
+    packGraph->add(bindPipeline);
+    packGraph->add(bindDescriptorSet);
+    return packGraph;
+}
+
+// convert float RGBA texels to R8G8B8A8_UNORM on the CPU, splitting the work across threads.
+// The inner loop is kept branch free over flat arrays so the compiler can vectorise it.
+void convertToUnorm8(const vsg::vec4Array2D& source, vsg::ubvec4Array2D& dest)
+{
+    const float* src = static_cast<const float*>(source.dataPointer());
+    uint8_t* dst = static_cast<uint8_t*>(dest.dataPointer());
+    size_t numComponents = source.valueCount() * 4;
+
+    auto convert = [src, dst](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            float v = src[i] * 255.0f + 0.5f;
+            v = v < 0.0f ? 0.0f : (v > 255.0f ? 255.0f : v);
+            dst[i] = static_cast<uint8_t>(v);
+        }
+    };
+
+    size_t numThreads = std::max(1u, std::thread::hardware_concurrency());
+    // at least 64 components per block so small images don't end up with a zero block size
+    size_t blockSize = std::max<size_t>(64, ((numComponents / numThreads + 63) / 64) * 64);
+    std::vector<std::thread> threads;
+    for (size_t begin = blockSize; begin < numComponents; begin += blockSize)
+    {
+        threads.emplace_back(convert, begin, std::min(begin + blockSize, numComponents));
+    }
+
+    convert(0, std::min(blockSize, numComponents));
+
+    for (auto& thread : threads) thread.join();
+}
+
+vsg::ref_ptr<vsg::Dispatch> createDispatch(int width, int height, int workgroupSize)
+{
+    return vsg::Dispatch::create(uint32_t(ceil(float(width)/float(workgroupSize))), uint32_t(ceil(float(height)/float(workgroupSize))), 1);
+}
+
+// buffers and commands for one frame of compute output, the commands fill the float buffer and when packing convert it into the packed buffer.
+struct ComputeFrame
+{
+    int width = 0;
+    int height = 0;
+    vsg::ref_ptr<vsg::Buffer> buffer;
+    vsg::DeviceMemoryPool::MemoryOffset bufferMemory;
+    vsg::ref_ptr<vsg::Buffer> packedBuffer;
+    vsg::DeviceMemoryPool::MemoryOffset packedMemory;
+    vsg::ref_ptr<vsg::Group> commands;
+
+    // tiled frames, the push constant values {origin.x, origin.y, imageWidth, imageHeight} for the tile
+    vsg::ref_ptr<vsg::vec4Value> tile;
+};
+
+// allocate the buffers for a frame and set up its commands, pass an empty packShaderFilename to read back the float buffer directly.
+bool createComputeFrame(ComputeFrame& frame, vsg::Device* device, vsg::DeviceMemoryPool* memoryPool, const vsg::Paths& searchPaths, const vsg::Path& packShaderFilename, int width, int height, int workgroupSize, bool tiled = false)
+{
+    bool gpuPack = !packShaderFilename.empty();
+
+    frame.width = width;
+    frame.height = height;
+
+    // allocate output storage buffer
+    VkDeviceSize bufferSize = sizeof(vsg::vec4) * width * height;
+    frame.buffer = vsg::Buffer::create(device, bufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE);
+    frame.bufferMemory = memoryPool->bind(frame.buffer, gpuPack ? VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT : (VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT));
+    if (!frame.bufferMemory.first)
+    {
+        std::cout<<"Unable to allocate memory for output buffer."<<std::endl;
+        return false;
+    }
+
+    // allocate the packed output buffer
+    VkDeviceSize packedSize = sizeof(vsg::ubvec4) * width * height;
+    if (gpuPack)
+    {
+        frame.packedBuffer = vsg::Buffer::create(device, packedSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE);
+        frame.packedMemory = memoryPool->bind(frame.packedBuffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        if (!frame.packedMemory.first)
+        {
+            std::cout<<"Unable to allocate memory for packed output buffer."<<std::endl;
+            return false;
+        }
+    }
+
+    // assign to a CommandGraph that binds the Pipeline and DescritorSets and calls Dispatch
+    auto commandGraph = createComputeGraph(searchPaths, frame.buffer, bufferSize, width, height, workgroupSize, tiled);
+    if (!commandGraph)
+    {
+        std::cout<<"Error : No shader loaded."<<std::endl;
+        return false;
+    }
+
+    if (tiled)
+    {
+        frame.tile = vsg::vec4Value::create();
+        commandGraph->addChild(vsg::PushConstants::create(VK_SHADER_STAGE_COMPUTE_BIT, 0, frame.tile));
+    }
+
+    commandGraph->addChild(createDispatch(width, height, workgroupSize));
+
+    frame.commands = vsg::Group::create();
+    frame.commands->addChild(commandGraph);
+
+    if (gpuPack)
+    {
+        auto packGraph = createPackGraph(packShaderFilename, frame.buffer, bufferSize, frame.packedBuffer, packedSize, width, height, workgroupSize);
+        if (!packGraph)
+        {
+            std::cout<<"Error : No pack shader loaded."<<std::endl;
+            return false;
+        }
+
+        packGraph->addChild(createDispatch(width, height, workgroupSize));
+
+        frame.commands->addChild(vsg::ComputeBarrier::create());
+        frame.commands->addChild(packGraph);
+    }
+
+    // make the shader writes visible to the host before the buffer is mapped
+    frame.commands->addChild(vsg::ComputeBarrier::create(VK_PIPELINE_STAGE_HOST_BIT, VK_ACCESS_HOST_READ_BIT));
+
+    return true;
+}
+
+// map the results of a completed frame and write them to file.
+void writeFrame(const ComputeFrame& frame, const vsg::Path& filename, bool outputAsFloat)
+{
+    if (frame.packedBuffer)
+    {
+        // Map the packed buffer memory and assign as a ubvec4Array2D that will automatically unmap itself on destruction.
+        auto packed = vsg::MappedData<vsg::ubvec4Array2D>::create(frame.packedMemory.first, frame.packedMemory.second, 0, frame.width, frame.height);
+        packed->setFormat(VK_FORMAT_R8G8B8A8_UNORM);
+
+        vsg::write(packed, filename);
+        return;
+    }
+
+    // Map the buffer memory and assign as a vec4Array2D that will automatically unmap itself on destruction.
+    auto image = vsg::MappedData<vsg::vec4Array2D>::create(frame.bufferMemory.first, frame.bufferMemory.second, 0, frame.width, frame.height); // deviceMemory, offset, flags and dimensions
+    image->setFormat(VK_FORMAT_R32G32B32A32_SFLOAT);
+
+    if (outputAsFloat)
+    {
+        vsg::write(image, filename);
+    }
+    else
+    {
+        // create a unsigned byte version of the image and then convert the texels across from float to unsigned byte.
+        auto dest = vsg::ubvec4Array2D::create(frame.width, frame.height);
+        dest->setFormat(VK_FORMAT_R8G8B8A8_UNORM);
+        convertToUnorm8(*image, *dest);
+
+        vsg::write(dest, filename);
+    }
+}
+
+// write the part of a completed tile that lies within the image into its rows of an RGBA8 image file,
+// each row is written at its final position so only a single tile needs to be held in memory.
+void writeTile(const ComputeFrame& frame, std::ostream& file, std::streamoff dataOffset, int imageWidth, int imageHeight)
+{
+    int originX = static_cast<int>(frame.tile->value().x);
+    int originY = static_cast<int>(frame.tile->value().y);
+    int columns = std::min(frame.width, imageWidth - originX);
+    int rows = std::min(frame.height, imageHeight - originY);
+
+    auto writeRows = [&](const vsg::ubvec4* texels)
+    {
+        for (int r = 0; r < rows; ++r)
+        {
+            file.seekp(dataOffset + (std::streamoff(originY + r) * imageWidth + originX) * sizeof(vsg::ubvec4));
+            file.write(reinterpret_cast<const char*>(texels + r * frame.width), columns * sizeof(vsg::ubvec4));
+        }
+    };
+
+    if (frame.packedBuffer)
+    {
+        auto packed = vsg::MappedData<vsg::ubvec4Array2D>::create(frame.packedMemory.first, frame.packedMemory.second, 0, frame.width, frame.height);
+        writeRows(static_cast<const vsg::ubvec4*>(packed->dataPointer()));
+    }
+    else
+    {
+        auto image = vsg::MappedData<vsg::vec4Array2D>::create(frame.bufferMemory.first, frame.bufferMemory.second, 0, frame.width, frame.height);
+        auto dest = vsg::ubvec4Array2D::create(frame.width, frame.height);
+        convertToUnorm8(*image, *dest);
+        writeRows(static_cast<const vsg::ubvec4*>(dest->dataPointer()));
+    }
+}
+
+// insert the frame number before the file extension, image.vsgb becomes image_0001.vsgb
+vsg::Path frameFilename(const vsg::Path& filename, uint32_t frameNumber)
+{
+    std::ostringstream str;
+    str<<"_"<<std::setw(4)<<std::setfill('0')<<frameNumber;
+
+    auto dot = filename.find_last_of('.');
+    auto slash = filename.find_last_of("/\\");
+    if (dot == vsg::Path::npos || (slash != vsg::Path::npos && dot < slash)) return filename + str.str();
+    return filename.substr(0, dot) + str.str() + filename.substr(dot);
+}
+
+struct BenchmarkConfiguration
+{
+    int workgroupSize;
+    int width;
+    int height;
+};
+
+// run numIterations dispatches for each configuration, timing the GPU execution with timestamp queries.
+int benchmark(vsg::Device* device, vsg::PhysicalDevice* physicalDevice, int queueFamily, VkQueue queue, vsg::DeviceMemoryPool* memoryPool, const vsg::Paths& searchPaths, const std::vector<BenchmarkConfiguration>& configurations, int numIterations)
+{
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(*physicalDevice, &properties);
+
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(*physicalDevice, &queueFamilyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(*physicalDevice, &queueFamilyCount, queueFamilies.data());
+
+    // not all implementations support timestamps on compute queues, in which case fall back to only reporting CPU side timings
+    uint32_t timestampValidBits = queueFamilies[queueFamily].timestampValidBits;
+    uint64_t timestampMask = timestampValidBits >= 64 ? ~uint64_t(0) : ((uint64_t(1) << timestampValidBits) - 1);
+    double timestampPeriod = properties.limits.timestampPeriod;
+
+    if (timestampValidBits == 0) std::cout<<"Timestamp queries not supported by queue, reporting CPU submit and wait times."<<std::endl;
+
+    auto queryPool = vsg::QueryPool::create(device, VK_QUERY_TYPE_TIMESTAMP, 2);
+    auto commandPool = vsg::CommandPool::create(device, queueFamily);
+
+    std::cout<<"workgroup   width  height   GPU ms/dispatch   Mpixels/s   CPU ms/submit"<<std::endl;
+
+    for (auto& config : configurations)
+    {
+        VkDeviceSize bufferSize = sizeof(vsg::vec4) * config.width * config.height;
+        auto buffer = vsg::Buffer::create(device, bufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE);
+        auto [bufferMemory, bufferOffset] = memoryPool->bind(buffer, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        if (!bufferMemory)
+        {
+            std::cout<<"Unable to allocate memory for "<<config.width<<"x"<<config.height<<" output buffer."<<std::endl;
+            continue;
+        }
+
+        auto commandGraph = createComputeGraph(searchPaths, buffer, bufferSize, config.width, config.height, config.workgroupSize);
+        if (!commandGraph)
+        {
+            std::cout<<"Error : No shader loaded."<<std::endl;
+            return 1;
+        }
+
+        auto dispatch = createDispatch(config.width, config.height, config.workgroupSize);
+
+        if (timestampValidBits > 0)
+        {
+            commandGraph->addChild(vsg::ResetQueryPool::create(queryPool, 0, 2));
+            commandGraph->addChild(vsg::WriteTimestamp::create(queryPool, 0, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT));
+        }
+
+        for (int i = 0; i < numIterations; ++i)
+        {
+            if (i > 0) commandGraph->addChild(vsg::ComputeBarrier::create());
+            commandGraph->addChild(dispatch);
+        }
+
+        if (timestampValidBits > 0)
+        {
+            commandGraph->addChild(vsg::WriteTimestamp::create(queryPool, 1, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT));
+        }
+
+        vsg::CompileTraversal compileTraversal(device);
+        compileTraversal.context.commandPool = commandPool;
+        compileTraversal.context.descriptorPool = vsg::DescriptorPool::create(device, 1, {{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1}});
+        commandGraph->accept(compileTraversal);
+
+        auto fence = vsg::Fence::create(device);
+
+        auto startTime = std::chrono::steady_clock::now();
+
+        vsg::submitCommandsToQueue(device, commandPool, fence, 100000000000, queue, [&](vsg::CommandBuffer& commandBuffer)
+        {
+            vsg::RecordTraversal recordTraversal(&commandBuffer);
+            commandGraph->accept(recordTraversal);
+        });
+
+        double cpuTime = std::chrono::duration<double, std::chrono::milliseconds::period>(std::chrono::steady_clock::now()-startTime).count() / double(numIterations);
+
+        double gpuTime = cpuTime;
+        if (timestampValidBits > 0)
+        {
+            auto timestamps = queryPool->getResults(0, 2);
+            // only the low timestampValidBits are meaningful, masking the difference keeps it correct when the counter wraps between the two queries
+            gpuTime = double((timestamps[1] - timestamps[0]) & timestampMask) * timestampPeriod * 1e-6 / double(numIterations);
+        }
+
+        double megaPixelsPerSecond = (double(config.width) * double(config.height) * 1e-6) / (gpuTime * 1e-3);
+
+        std::cout<<std::setw(9)<<config.workgroupSize<<std::setw(8)<<config.width<<std::setw(8)<<config.height
+                 <<std::setw(18)<<gpuTime<<std::setw(12)<<megaPixelsPerSecond<<std::setw(16)<<cpuTime<<std::endl;
+
+        memoryPool->release(bufferMemory, bufferOffset);
+    }
+
+    return 0;
+}
 
 int main(int argc, char** argv)
 {
@@ -13,8 +396,28 @@ int main(int argc, char** argv)
     auto workgroupSize = arguments.value(32, "-w");
     auto outputFilename = arguments.value<std::string>("", "-o");
     auto outputAsFloat = arguments.read("-f");
+    auto cpuPack = arguments.read("--cpu-pack");
+    auto reportMemory = arguments.read("--memory-stats");
+    auto numBenchmarkIterations = arguments.value(0, "--benchmark");
+    auto numStreamFrames = arguments.value(0u, "--stream");
+    auto numStreamBuffers = arguments.value(2u, "--stream-buffers");
+    auto tileSize = arguments.value(0, "--tile-size");
+
+    // workgroup sizes and image dimensions to sweep over when benchmarking, default to the -w, --width and --height settings
+    std::vector<int> sweepWorkgroupSizes;
+    int sweepWorkgroupSize;
+    while (arguments.read("--sweep-w", sweepWorkgroupSize)) sweepWorkgroupSizes.push_back(sweepWorkgroupSize);
+    if (sweepWorkgroupSizes.empty()) sweepWorkgroupSizes.push_back(workgroupSize);
+
+    std::vector<std::pair<int, int>> sweepDimensions;
+    int sweepWidth, sweepHeight;
+    while (arguments.read("--sweep-size", sweepWidth, sweepHeight)) sweepDimensions.emplace_back(sweepWidth, sweepHeight);
+    if (sweepDimensions.empty()) sweepDimensions.emplace_back(width, height);
+
     if (arguments.errors()) return arguments.writeErrorMessages(std::cerr);
 
+    if (numStreamBuffers < 1) numStreamBuffers = 1;
+
     vsg::Names instanceExtensions;
     vsg::Names requestedLayers;
     vsg::Names deviceExtensions;
@@ -26,18 +429,6 @@ int main(int argc, char** argv)
     }
 
     vsg::Paths searchPaths = vsg::getEnvPaths("VSG_FILE_PATH");
-    vsg::ref_ptr<vsg::ShaderStage> computeStage = vsg::ShaderStage::read(VK_SHADER_STAGE_COMPUTE_BIT, "main", vsg::findFile("shaders/comp.spv", searchPaths));
-    if (!computeStage)
-    {
-        std::cout<<"Error : No shader loaded."<<std::endl;
-        return 1;
-    }
-
-    computeStage->setSpecializationConstants({
-        {0, vsg::intValue::create(width)},
-        {1, vsg::intValue::create(height)},
-        {2, vsg::intValue::create(workgroupSize)}
-    });
 
     vsg::Names validatedNames = vsg::validateInstancelayerNames(requestedLayers);
 
@@ -62,37 +453,128 @@ int main(int argc, char** argv)
     // get the queue for the compute commands
     auto computeQueue = device->getQueue(computeQueueFamily);
 
-    // allocate output storage buffer
-    VkDeviceSize bufferSize = sizeof(vsg::vec4) * width * height;
-    vsg::ref_ptr<vsg::Buffer> buffer =  vsg::Buffer::create(device, bufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE);
-    vsg::ref_ptr<vsg::DeviceMemory>  bufferMemory = vsg::DeviceMemory::create(device, buffer,  VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-    buffer->bind(bufferMemory, 0);
+    // sub-allocate device memory from pooled blocks rather than creating a DeviceMemory per Buffer
+    auto memoryPool = vsg::DeviceMemoryPool::create(device);
 
-    // set up DescriptorSetLayout, DecriptorSet and BindDescriptorSets
-    vsg::DescriptorSetLayoutBindings descriptorBindings { {0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr} };
-    auto descriptorSetLayout = vsg::DescriptorSetLayout::create(descriptorBindings);
-    vsg::Descriptors descriptors { vsg::DescriptorBuffer::create(vsg::BufferDataList{vsg::BufferData(buffer, 0, bufferSize)}, 0, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER) };
+    if (numBenchmarkIterations > 0)
+    {
+        std::vector<BenchmarkConfiguration> configurations;
+        for (auto& [w, h] : sweepDimensions)
+        {
+            for (auto size : sweepWorkgroupSizes) configurations.push_back(BenchmarkConfiguration{size, w, h});
+        }
 
-    auto descriptorSet = vsg::DescriptorSet::create(descriptorSetLayout, descriptors);
-    auto pipelineLayout = vsg::PipelineLayout::create(vsg::DescriptorSetLayouts{descriptorSetLayout}, vsg::PushConstantRanges{});
-    auto bindDescriptorSet = vsg::BindDescriptorSet::create(VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, descriptorSet);
+        int result = benchmark(device, physicalDevice, computeQueueFamily, computeQueue, memoryPool, searchPaths, configurations, numBenchmarkIterations);
+        if (reportMemory) memoryPool->report(std::cout);
+        return result;
+    }
 
-    // set up the compute pipeline
-    auto pipeline = vsg::ComputePipeline::create(pipelineLayout, computeStage);
-    auto bindPipeline = vsg::BindComputePipeline::create(pipeline);
+    // when writing an 8 bit image pack the texels on the GPU so only a quarter of the bytes need to be read back,
+    // the float buffer can then stay in device local memory.
+    auto packShaderFilename = vsg::findFile("shaders/pack.spv", searchPaths);
+    bool gpuPack = !outputFilename.empty() && !outputAsFloat && !cpuPack && !packShaderFilename.empty();
 
-    // assign to a CommandGraph that binds the Pipeline and DescritorSets and calls Dispatch
-    auto commandGraph = vsg::StateGroup::create();
-    commandGraph->add(bindPipeline);
-    commandGraph->add(bindDescriptorSet);
-    commandGraph->addChild(vsg::Dispatch::create(uint32_t(ceil(float(width)/float(workgroupSize))), uint32_t(ceil(float(height)/float(workgroupSize))), 1));
+    if (tileSize > 0)
+    {
+        // render the image a tile at a time through the ComputeStream slots, so peak memory only depends on the tile size and number of slots
+        if (outputAsFloat) std::cout<<"Warning: tiled output is written as RGBA8, ignoring -f."<<std::endl;
+
+        // tiles are written straight to their rows in the file, which the vsg::ReaderWriters can't do, so only binary PAM output is supported
+        if (!outputFilename.empty() && vsg::fileExtension(outputFilename) != "pam")
+        {
+            std::cout<<"Tiled output is written as a binary PAM image, -o "<<outputFilename<<" must have a .pam extension."<<std::endl;
+            return 1;
+        }
+
+        uint32_t numTilesX = (width + tileSize - 1) / tileSize;
+        uint32_t numTilesY = (height + tileSize - 1) / tileSize;
+
+        auto computeStream = vsg::ComputeStream::create(device, computeQueueFamily);
+        std::vector<ComputeFrame> tiles(numStreamBuffers);
+
+        vsg::CompileTraversal compileTraversal(device);
+        compileTraversal.context.commandPool = vsg::CommandPool::create(device, computeQueueFamily);
+        compileTraversal.context.descriptorPool = vsg::DescriptorPool::create(device, 2 * numStreamBuffers, {{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 3 * numStreamBuffers}});
+
+        vsg::Path tilePackShaderFilename = (!outputFilename.empty() && !cpuPack) ? packShaderFilename : vsg::Path();
+        for (auto& tile : tiles)
+        {
+            if (!createComputeFrame(tile, device, memoryPool, searchPaths, tilePackShaderFilename, tileSize, tileSize, workgroupSize, true)) return 1;
+
+            tile.commands->accept(compileTraversal);
+            computeStream->addSlot(tile.commands);
+        }
+
+        // the tiles are written into a binary PAM file, its header is followed by the raw RGBA8 rows so tiles can be written straight to their location
+        std::ofstream file;
+        std::streamoff dataOffset = 0;
+        if (!outputFilename.empty())
+        {
+            file.open(outputFilename, std::ios::out | std::ios::binary);
+            if (!file)
+            {
+                std::cout<<"Unable to open "<<outputFilename<<" for writing."<<std::endl;
+                return 1;
+            }
+
+            file<<"P7\nWIDTH "<<width<<"\nHEIGHT "<<height<<"\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n";
+            dataOffset = file.tellp();
+        }
+
+        computeStream->run(numTilesX * numTilesY, [&](uint32_t tileNumber, uint32_t slot)
+        {
+            float originX = float((tileNumber % numTilesX) * tileSize);
+            float originY = float((tileNumber / numTilesX) * tileSize);
+            tiles[slot].tile->value() = vsg::vec4(originX, originY, float(width), float(height));
+        },
+        [&](uint32_t /*tileNumber*/, uint32_t slot)
+        {
+            if (file.is_open()) writeTile(tiles[slot], file, dataOffset, width, height);
+        });
+
+        std::cout<<"Rendered "<<width<<"x"<<height<<" image as "<<numTilesX<<"x"<<numTilesY<<" tiles of "<<tileSize<<"x"<<tileSize<<std::endl;
+        computeStream->report(std::cout);
+        if (reportMemory) memoryPool->report(std::cout);
+        return 0;
+    }
+
+    if (numStreamFrames > 0)
+    {
+        // each slot has its own set of buffers so its readback can overlap the dispatches of the other slots
+        auto computeStream = vsg::ComputeStream::create(device, computeQueueFamily);
+        std::vector<ComputeFrame> frames(numStreamBuffers);
+
+        vsg::CompileTraversal compileTraversal(device);
+        compileTraversal.context.commandPool = vsg::CommandPool::create(device, computeQueueFamily);
+        compileTraversal.context.descriptorPool = vsg::DescriptorPool::create(device, 2 * numStreamBuffers, {{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 3 * numStreamBuffers}});
+
+        for (auto& frame : frames)
+        {
+            if (!createComputeFrame(frame, device, memoryPool, searchPaths, gpuPack ? packShaderFilename : vsg::Path(), width, height, workgroupSize)) return 1;
+
+            frame.commands->accept(compileTraversal);
+            computeStream->addSlot(frame.commands);
+        }
+
+        computeStream->run(numStreamFrames, nullptr, [&](uint32_t frameNumber, uint32_t slot)
+        {
+            if (!outputFilename.empty()) writeFrame(frames[slot], frameFilename(outputFilename, frameNumber), outputAsFloat);
+        });
+
+        computeStream->report(std::cout);
+        if (reportMemory) memoryPool->report(std::cout);
+        return 0;
+    }
+
+    ComputeFrame frame;
+    if (!createComputeFrame(frame, device, memoryPool, searchPaths, gpuPack ? packShaderFilename : vsg::Path(), width, height, workgroupSize)) return 1;
 
     // compile the Vulkan objects
     vsg::CompileTraversal compileTraversal(device);
     compileTraversal.context.commandPool = vsg::CommandPool::create(device, computeQueueFamily);
-    compileTraversal.context.descriptorPool = vsg::DescriptorPool::create(device, 1, {{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1}});
+    compileTraversal.context.descriptorPool = vsg::DescriptorPool::create(device, 2, {{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 3}});
 
-    commandGraph->accept(compileTraversal);
+    frame.commands->accept(compileTraversal);
 
     // setup fence
     vsg::ref_ptr<vsg::Fence> fence = vsg::Fence::create(device);
@@ -103,37 +585,15 @@ int main(int argc, char** argv)
     vsg::submitCommandsToQueue(device, compileTraversal.context.commandPool, fence, 100000000000, computeQueue, [&](vsg::CommandBuffer& commandBuffer)
     {
         vsg::RecordTraversal recordTraversal(&commandBuffer);
-        commandGraph->accept(recordTraversal);
+        frame.commands->accept(recordTraversal);
     });
 
     auto time = std::chrono::duration<float, std::chrono::milliseconds::period>(std::chrono::steady_clock::now()-startTime).count();
     std::cout<<"Time to run commands "<<time<<"ms"<<std::endl;
 
-    if (!outputFilename.empty())
-    {
-        // Map the buffer memory and assign as a vec4Array2D that will automatically unmap itself on destruction.
-        auto image = vsg::MappedData<vsg::vec4Array2D>::create(bufferMemory, 0, 0, width, height); // deviceMemory, offset, flags and dimensions
-        image->setFormat(VK_FORMAT_R32G32B32A32_SFLOAT);
+    if (!outputFilename.empty()) writeFrame(frame, outputFilename, outputAsFloat);
 
-        if (outputAsFloat)
-        {
-            vsg::write(image, outputFilename);
-        }
-        else
-        {
-            // create a unsigned byte version of the image and then copy the texels across converting colours from float to unsigned byte.
-            auto dest = vsg::ubvec4Array2D::create(width, height);
-            dest->setFormat(VK_FORMAT_R8G8B8A8_UNORM);
-            using component_type = uint8_t;
-            auto c_itr = dest->begin();
-            for(auto& colour : *image)
-            {
-                (c_itr++)->set(static_cast<component_type>(colour.r*255.0), static_cast<component_type>(colour.g*255.0), static_cast<component_type>(colour.b*255.0), static_cast<component_type>(colour.a*255.0));
-            }
-
-            vsg::write(dest, outputFilename);
-        }
-    }
+    if (reportMemory) memoryPool->report(std::cout);
 
     // clean up done automatically thanks to ref_ptr<>
     return 0;
@@ -0,0 +1,252 @@
+#include "IndirectCulling.h"
+#include "ComputeBarrier.h"
+#include "TransferBatch.h"
+
+#include <iostream>
+
+using namespace vsg;
+
+namespace
+{
+    constexpr uint32_t workgroupSize = 64;     // local_size_x of shaders/cull.spv
+    constexpr uint32_t drawCommandWords = 8;   // the cull shader's DrawCommand: VkDrawIndexedIndirectCommand, the mesh's base in the visible buffer, padding
+    constexpr uint32_t drawCommandStride = drawCommandWords * sizeof(uint32_t);
+    constexpr VkDeviceSize maxUpdateSize = 65536; // vkCmdUpdateBuffer limit
+} // namespace
+
+//
+// ResetDrawCommands
+//
+void ResetDrawCommands::dispatch(CommandBuffer& commandBuffer) const
+{
+    // the previous frame's draws read the draw commands and visible instances, so have to finish before they are rewritten
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 0, nullptr);
+
+    vkCmdUpdateBuffer(commandBuffer, *_destination, 0, _initialCommands->dataSize(), _initialCommands->dataPointer());
+
+    VkMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+}
+
+//
+// DrawIndexedIndirectInstances
+//
+void DrawIndexedIndirectInstances::dispatch(CommandBuffer& commandBuffer) const
+{
+    VkBuffer visible = *_visible;
+    for (uint32_t mesh = 0; mesh < _bases.size(); ++mesh)
+    {
+        VkDeviceSize offset = VkDeviceSize(_bases[mesh]) * sizeof(vec4);
+        vkCmdBindVertexBuffers(commandBuffer, _instanceBinding, 1, &visible, &offset);
+        vkCmdDrawIndexedIndirect(commandBuffer, *_drawCommands, VkDeviceSize(mesh) * drawCommandStride, 1, drawCommandStride);
+    }
+}
+
+//
+// IndirectCulling
+//
+IndirectCulling::IndirectCulling() :
+    _view(vec4Array::create(7))
+{
+}
+
+IndirectCulling::~IndirectCulling()
+{
+    if (_drawCommandsData) vkUnmapMemory(*_device, *_drawCommandsMemory);
+}
+
+bool IndirectCulling::setup(Device* device, TransferBatch* transferBatch, ref_ptr<ShaderStage> cullShader)
+{
+    if (!cullShader || meshes.empty() || !instances || instances->valueCount() == 0 || !instanceMeshes || instanceMeshes->valueCount() != instances->valueCount())
+    {
+        std::cout << "Warning: IndirectCulling requires the cull shader, at least one mesh and instance, and the mesh of each instance." << std::endl;
+        return false;
+    }
+
+    auto numInstances = static_cast<uint32_t>(instances->valueCount());
+    auto numMeshes = static_cast<uint32_t>(meshes.size());
+    auto numOccluders = occluders ? static_cast<uint32_t>(occluders->valueCount()) : 0u;
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(*device->getPhysicalDevice(), &properties);
+
+    uint32_t numWorkgroups = (numInstances + workgroupSize - 1) / workgroupSize;
+    if (numWorkgroups > properties.limits.maxComputeWorkGroupCount[0])
+    {
+        std::cout << "Warning: IndirectCulling unable to cull " << numInstances << " instances, the device can dispatch " << properties.limits.maxComputeWorkGroupCount[0] * workgroupSize << std::endl;
+        return false;
+    }
+
+    if (numMeshes * drawCommandStride > maxUpdateSize)
+    {
+        std::cout << "Warning: IndirectCulling unable to draw " << numMeshes << " meshes, the draw commands are limited to " << maxUpdateSize / drawCommandStride << std::endl;
+        return false;
+    }
+
+    // each mesh's instances are appended to their own range of the visible buffer, sized for all of them passing
+    std::vector<uint32_t> counts(numMeshes, 0);
+    for (auto mesh : *instanceMeshes)
+    {
+        if (mesh >= numMeshes)
+        {
+            std::cout << "Warning: IndirectCulling instance of mesh " << mesh << " when there are only " << numMeshes << " meshes." << std::endl;
+            return false;
+        }
+        ++counts[mesh];
+    }
+
+    _bases.resize(numMeshes);
+    auto initialCommands = uintArray::create(numMeshes * drawCommandWords);
+    auto meshBounds = vec4Array::create(numMeshes);
+    uint32_t base = 0;
+    for (uint32_t m = 0; m < numMeshes; ++m)
+    {
+        auto& mesh = meshes[m];
+        uint32_t* command = &(*initialCommands)[m * drawCommandWords];
+        command[0] = mesh.indexCount;
+        command[1] = 0; // instanceCount, incremented by the cull shader for each visible instance
+        command[2] = mesh.firstIndex;
+        command[3] = static_cast<uint32_t>(mesh.vertexOffset);
+        command[4] = 0; // firstInstance, the instances are offset by binding the visible buffer at the mesh's base
+        command[5] = base;
+        command[6] = 0;
+        command[7] = 0;
+
+        (*meshBounds)[m] = mesh.bounds;
+        _bases[m] = base;
+        base += counts[m];
+    }
+
+    // a descriptor can't refer to an empty buffer so there is always at least one occluder, the count passed to the shader says how many are used
+    auto occluderSpheres = numOccluders > 0 ? occluders : vec4Array::create(1);
+    (*_view)[6].w = static_cast<float>(numOccluders);
+
+    // upload the instances, meshes and occluders to device local buffers, each in its own buffer to meet the storage buffer offset alignment
+    VkBufferUsageFlags storageUsage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    auto instanceData = transferBatch->add(DataList{instances}, storageUsage);
+    auto instanceMeshData = transferBatch->add(DataList{instanceMeshes}, storageUsage);
+    auto meshBoundsData = transferBatch->add(DataList{meshBounds}, storageUsage);
+    auto occluderData = transferBatch->add(DataList{occluderSpheres}, storageUsage);
+    if (instanceData.empty() || instanceMeshData.empty() || meshBoundsData.empty() || occluderData.empty())
+    {
+        std::cout << "Warning: IndirectCulling unable to upload the instances." << std::endl;
+        return false;
+    }
+    transferBatch->flush();
+
+    // the draw commands are host visible so visibleCounts() can read them back, the visible instances stay on the device
+    _device = device;
+
+    VkDeviceSize drawCommandsSize = initialCommands->dataSize();
+    _drawCommands = Buffer::create(device, drawCommandsSize, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_SHARING_MODE_EXCLUSIVE);
+    _drawCommandsMemory = DeviceMemory::create(device, _drawCommands, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    _drawCommands->bind(_drawCommandsMemory, 0);
+
+    void* data = nullptr;
+    if (vkMapMemory(*device, *_drawCommandsMemory, 0, drawCommandsSize, 0, &data) == VK_SUCCESS)
+    {
+        _drawCommandsData = static_cast<uint32_t*>(data);
+    }
+    else
+    {
+        std::cout << "Warning: IndirectCulling unable to map the draw commands, visible counts won't be available." << std::endl;
+    }
+
+    VkDeviceSize visibleSize = VkDeviceSize(numInstances) * sizeof(vec4);
+    _visible = Buffer::create(device, visibleSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE);
+    _visibleMemory = DeviceMemory::create(device, _visible, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    _visible->bind(_visibleMemory, 0);
+
+    // set up the compute pipeline and its descriptor set, bindings in the order of the cull shader
+    DescriptorSetLayoutBindings descriptorBindings;
+    for (uint32_t binding = 0; binding < 6; ++binding)
+    {
+        descriptorBindings.push_back({binding, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT, nullptr});
+    }
+    auto descriptorSetLayout = DescriptorSetLayout::create(descriptorBindings);
+
+    Descriptors descriptors{
+        DescriptorBuffer::create(instanceData, 0, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER),
+        DescriptorBuffer::create(instanceMeshData, 1, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER),
+        DescriptorBuffer::create(meshBoundsData, 2, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER),
+        DescriptorBuffer::create(occluderData, 3, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER),
+        DescriptorBuffer::create(BufferDataList{BufferData(_drawCommands, 0, drawCommandsSize)}, 4, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER),
+        DescriptorBuffer::create(BufferDataList{BufferData(_visible, 0, visibleSize)}, 5, 0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
+    };
+    auto descriptorSet = DescriptorSet::create(descriptorSetLayout, descriptors);
+
+    PushConstantRanges pushConstantRanges{
+        {VK_SHADER_STAGE_COMPUTE_BIT, 0, static_cast<uint32_t>(_view->dataSize())}
+    };
+    auto pipelineLayout = PipelineLayout::create(DescriptorSetLayouts{descriptorSetLayout}, pushConstantRanges);
+    auto pipeline = ComputePipeline::create(pipelineLayout, cullShader);
+
+    auto cull = StateGroup::create();
+    cull->add(BindComputePipeline::create(pipeline));
+    cull->add(BindDescriptorSet::create(VK_PIPELINE_BIND_POINT_COMPUTE, pipelineLayout, descriptorSet));
+
+    cull->addChild(ResetDrawCommands::create(initialCommands, _drawCommands));
+    cull->addChild(PushConstants::create(VK_SHADER_STAGE_COMPUTE_BIT, 0, _view));
+    cull->addChild(Dispatch::create(numWorkgroups, 1, 1));
+
+    // make the draw commands and visible instances available to the indirect draws and vertex input, and to the host for visibleCounts()
+    cull->addChild(ComputeBarrier::create(VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_HOST_BIT,
+                                          VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_HOST_READ_BIT));
+
+    _cullCommands = cull;
+    return true;
+}
+
+ref_ptr<Command> IndirectCulling::createDrawCommand(uint32_t instanceBinding) const
+{
+    if (!_drawCommands) return {};
+    return DrawIndexedIndirectInstances::create(_drawCommands, _visible, _bases, instanceBinding);
+}
+
+void IndirectCulling::setView(const dmat4& projectionView, const dvec3& eye)
+{
+    auto row = [&](int i) { return dvec4(projectionView[0][i], projectionView[1][i], projectionView[2][i], projectionView[3][i]); };
+
+    // planes of -w <= x, y, z <= w in clip space, facing inwards. For a 0 to 1 depth range the near plane lies behind the true one,
+    // which only lets a few more instances through.
+    dvec4 planes[6] = {row(3) + row(0), row(3) - row(0), row(3) + row(1), row(3) - row(1), row(3) + row(2), row(3) - row(2)};
+    for (int i = 0; i < 6; ++i)
+    {
+        auto& plane = planes[i];
+        double scale = 1.0 / length(dvec3(plane.x, plane.y, plane.z));
+        (*_view)[i] = vec4(static_cast<float>(plane.x * scale), static_cast<float>(plane.y * scale), static_cast<float>(plane.z * scale), static_cast<float>(plane.w * scale));
+    }
+
+    auto& eyeAndCount = (*_view)[6];
+    eyeAndCount = vec4(static_cast<float>(eye.x), static_cast<float>(eye.y), static_cast<float>(eye.z), eyeAndCount.w);
+}
+
+std::vector<uint32_t> IndirectCulling::visibleCounts() const
+{
+    std::vector<uint32_t> counts(_bases.size(), 0);
+    if (_drawCommandsData)
+    {
+        for (size_t m = 0; m < counts.size(); ++m) counts[m] = _drawCommandsData[m * drawCommandWords + 1];
+    }
+    return counts;
+}
+
+void IndirectCulling::report(std::ostream& out) const
+{
+    size_t numInstances = instances ? instances->valueCount() : 0;
+    size_t numOccluders = occluders ? occluders->valueCount() : 0;
+    out << "IndirectCulling " << numInstances << " instances of " << meshes.size() << " meshes, " << numOccluders << " occluders" << std::endl;
+
+    auto counts = visibleCounts();
+    size_t numVisible = 0;
+    for (auto count : counts) numVisible += count;
+
+    out << "    visible instances " << numVisible;
+    if (numInstances > 0) out << " (" << (100.0 * double(numVisible) / double(numInstances)) << "%)";
+    out << ", per mesh";
+    for (auto count : counts) out << " " << count;
+    out << std::endl;
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <vsg/all.h>
+
+#include <ostream>
+#include <vector>
+
+namespace vsg
+{
+
+    class TransferBatch;
+
+    // a mesh drawn from the bound vertex and index buffers, bounds is its bounding sphere with the centre in xyz and the radius in w
+    struct IndirectMesh
+    {
+        uint32_t indexCount = 0;
+        uint32_t firstIndex = 0;
+        int32_t vertexOffset = 0;
+        vec4 bounds;
+    };
+
+    //
+    // ResetDrawCommands writes the initial draw commands, with no instances, over the ones the cull shader appends to. It waits for the previous
+    // frame's indirect draws to finish reading the buffers and makes the update visible to the following compute dispatch.
+    // vkCmdUpdateBuffer limits the draw commands to 65536 bytes.
+    //
+    class ResetDrawCommands : public Inherit<Command, ResetDrawCommands>
+    {
+    public:
+        ResetDrawCommands(ref_ptr<uintArray> initialCommands, Buffer* destination) :
+            _initialCommands(initialCommands),
+            _destination(destination) {}
+
+        void dispatch(CommandBuffer& commandBuffer) const override;
+
+    protected:
+        ref_ptr<uintArray> _initialCommands;
+        ref_ptr<Buffer> _destination;
+    };
+    VSG_type_name(ResetDrawCommands)
+
+    //
+    // DrawIndexedIndirectInstances draws each mesh's visible instances with a vkCmdDrawIndexedIndirect, binding the mesh's range of the visible
+    // buffer to instanceBinding first. One draw per mesh keeps to the core features that vsg::Window enables: multiDrawIndirect is needed
+    // for a drawCount greater than one, and drawIndirectFirstInstance for the draw commands to offset into a single binding.
+    //
+    class DrawIndexedIndirectInstances : public Inherit<Command, DrawIndexedIndirectInstances>
+    {
+    public:
+        DrawIndexedIndirectInstances(Buffer* drawCommands, Buffer* visible, const std::vector<uint32_t>& bases, uint32_t instanceBinding) :
+            _drawCommands(drawCommands),
+            _visible(visible),
+            _bases(bases),
+            _instanceBinding(instanceBinding) {}
+
+        void dispatch(CommandBuffer& commandBuffer) const override;
+
+    protected:
+        ref_ptr<Buffer> _drawCommands;
+        ref_ptr<Buffer> _visible;
+        std::vector<uint32_t> _bases;
+        uint32_t _instanceBinding;
+    };
+    VSG_type_name(DrawIndexedIndirectInstances)
+
+    //
+    // IndirectCulling culls instances on the GPU so that the record traversal doesn't have to visit them. A compute pass tests each instance's
+    // bounding sphere against the view frustum and the occluder spheres, appends the instances that pass to a visible buffer grouped by mesh,
+    // and counts them into a VkDrawIndexedIndirectCommand per mesh. The recorded commands are the same however many instances there are.
+    //
+    class IndirectCulling : public Inherit<Object, IndirectCulling>
+    {
+    public:
+        IndirectCulling();
+
+        std::vector<IndirectMesh> meshes;
+        ref_ptr<vec4Array> instances;      // xyz position and w scale of each instance
+        ref_ptr<uintArray> instanceMeshes; // index into meshes of each instance
+        ref_ptr<vec4Array> occluders;      // spheres within opaque geometry, xyz centre and w radius
+
+        // upload the instances and set up the buffers and commands using shaders/cull.spv, returns false on failure
+        bool setup(Device* device, TransferBatch* transferBatch, ref_ptr<ShaderStage> cullShader);
+
+        // the cull dispatch and the barriers around it, to record ahead of the RenderGraph as compute work can't be recorded within a render pass
+        ref_ptr<Node> cullCommands() const { return _cullCommands; }
+
+        // draw command for the visible instances, read by the vertex shader from instanceBinding as a per instance vec4
+        ref_ptr<Command> createDrawCommand(uint32_t instanceBinding) const;
+
+        // set the frustum and eye point that the next recorded cull uses
+        void setView(const dmat4& projectionView, const dvec3& eye);
+
+        // number of visible instances of each mesh from the last completed cull, the device must be idle
+        std::vector<uint32_t> visibleCounts() const;
+
+        void report(std::ostream& out) const;
+
+    protected:
+        virtual ~IndirectCulling();
+
+        ref_ptr<Device> _device;
+        ref_ptr<vec4Array> _view; // push constants: six frustum planes then the eye point with the number of occluders in w
+        std::vector<uint32_t> _bases;
+
+        ref_ptr<Buffer> _drawCommands;
+        ref_ptr<DeviceMemory> _drawCommandsMemory;
+        uint32_t* _drawCommandsData = nullptr;
+        ref_ptr<Buffer> _visible;
+        ref_ptr<DeviceMemory> _visibleMemory;
+
+        ref_ptr<Node> _cullCommands;
+    };
+    VSG_type_name(IndirectCulling)
+
+} // namespace vsg
@@ -0,0 +1,313 @@
+#include <vsg/all.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+#include "GeometryBuilder.h"
+#include "IndirectCulling.h"
+#include "TransferBatch.h"
+#include "VertexFormat.h"
+
+int main(int argc, char** argv)
+{
+    // set up defaults and read command line arguments to override them
+    vsg::CommandLine arguments(&argc, argv);
+    auto debugLayer = arguments.read({"--debug","-d"});
+    auto apiDumpLayer = arguments.read({"--api","-a"});
+    auto [width, height] = arguments.value(std::pair<uint32_t, uint32_t>(1280, 720), {"--window", "-w"});
+    auto numInstances = arguments.value(1000000u, {"--instances", "-n"});
+    auto numOccluders = arguments.value(64u, {"--occluders", "-o"});
+    auto direct = arguments.read("--direct");
+    auto numFrames = arguments.value(-1, "-f");
+    if (arguments.errors()) return arguments.writeErrorMessages(std::cerr);
+
+    // set up search paths to SPIRV shaders and textures
+    vsg::Paths searchPaths = vsg::getEnvPaths("VSG_FILE_PATH");
+
+    // load shaders, the vertex shader positions and scales each instance by a per instance vec4
+    vsg::ref_ptr<vsg::ShaderStage> vertexShader = vsg::ShaderStage::read(VK_SHADER_STAGE_VERTEX_BIT, "main", vsg::findFile("shaders/vert_indirect.spv", searchPaths));
+    vsg::ref_ptr<vsg::ShaderStage> fragmentShader = vsg::ShaderStage::read(VK_SHADER_STAGE_FRAGMENT_BIT, "main", vsg::findFile("shaders/frag_PushConstants.spv", searchPaths));
+    vsg::ref_ptr<vsg::ShaderStage> cullShader = vsg::ShaderStage::read(VK_SHADER_STAGE_COMPUTE_BIT, "main", vsg::findFile("shaders/cull.spv", searchPaths));
+    if (!vertexShader || !fragmentShader || !cullShader)
+    {
+        std::cout<<"Could not create shaders."<<std::endl;
+        return 1;
+    }
+
+    // read texture image
+    vsg::Path textureFile("textures/lz.vsgb");
+    auto textureData = vsg::read_cast<vsg::Data>(vsg::findFile(textureFile, searchPaths));
+    if (!textureData)
+    {
+        std::cout<<"Could not read texture file : "<<textureFile<<std::endl;
+        return 1;
+    }
+
+    // two meshes sharing the vertex and index arrays: a unit box for buildings and occluders, and a pyramid for trees
+    auto vertices = vsg::vec3Array::create(
+    {
+        {-0.5f, -0.5f, -0.5f},
+        {0.5f,  -0.5f, -0.5f},
+        {0.5f , 0.5f, -0.5f},
+        {-0.5f, 0.5f, -0.5f},
+        {-0.5f, -0.5f, 0.5f},
+        {0.5f,  -0.5f, 0.5f},
+        {0.5f , 0.5f, 0.5f},
+        {-0.5f, 0.5f, 0.5f},
+        {-0.5f, -0.5f, -0.5f},
+        {0.5f,  -0.5f, -0.5f},
+        {0.5f , 0.5f, -0.5f},
+        {-0.5f, 0.5f, -0.5f},
+        {0.0f, 0.0f, 0.5f}
+    });
+
+    auto colors = vsg::vec3Array::create(
+    {
+        {0.6f, 0.6f, 0.6f},
+        {0.6f, 0.6f, 0.6f},
+        {0.6f, 0.6f, 0.6f},
+        {0.6f, 0.6f, 0.6f},
+        {1.0f, 1.0f, 1.0f},
+        {1.0f, 1.0f, 1.0f},
+        {1.0f, 1.0f, 1.0f},
+        {1.0f, 1.0f, 1.0f},
+        {0.2f, 0.4f, 0.1f},
+        {0.2f, 0.4f, 0.1f},
+        {0.2f, 0.4f, 0.1f},
+        {0.2f, 0.4f, 0.1f},
+        {0.3f, 0.8f, 0.2f}
+    });
+
+    auto texcoords = vsg::vec2Array::create(
+    {
+        {0.0f, 0.0f},
+        {1.0f, 0.0f},
+        {1.0f, 1.0f},
+        {0.0f, 1.0f},
+        {0.0f, 0.0f},
+        {1.0f, 0.0f},
+        {1.0f, 1.0f},
+        {0.0f, 1.0f},
+        {0.0f, 0.0f},
+        {1.0f, 0.0f},
+        {1.0f, 1.0f},
+        {0.0f, 1.0f},
+        {0.5f, 0.5f}
+    });
+
+    std::vector<uint32_t> indexValues
+    {
+        // box
+        4, 5, 6,  6, 7, 4,
+        0, 3, 2,  2, 1, 0,
+        0, 1, 5,  5, 4, 0,
+        1, 2, 6,  6, 5, 1,
+        2, 3, 7,  7, 6, 2,
+        3, 0, 4,  4, 7, 3,
+        // pyramid, relative to its vertexOffset
+        0, 3, 2,  2, 1, 0,
+        0, 1, 4,
+        1, 2, 4,
+        2, 3, 4,
+        3, 0, 4
+    };
+    auto indices = vsg::createIndices(indexValues, vsg::indexType(static_cast<uint32_t>(vertices->valueCount())));
+
+    const float boundingRadius = std::sqrt(0.75f);
+    const uint32_t boxMesh = 0;
+    const uint32_t pyramidMesh = 1;
+    std::vector<vsg::IndirectMesh> meshes
+    {
+        {36, 0, 0, vsg::vec4(0.0f, 0.0f, 0.0f, boundingRadius)},
+        {18, 36, 8, vsg::vec4(0.0f, 0.0f, 0.0f, boundingRadius)}
+    };
+
+    // scatter the instances over a grid, each standing on the ground plane, followed by large boxes that serve as the occluders
+    std::mt19937 random(1);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    const float spacing = 2.0f;
+    auto side = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(std::max(numInstances, 1u)))));
+    float extent = static_cast<float>(side) * spacing;
+
+    auto instances = vsg::vec4Array::create(numInstances + numOccluders);
+    auto instanceMeshes = vsg::uintArray::create(numInstances + numOccluders);
+    for (uint32_t i = 0; i < numInstances; ++i)
+    {
+        float scale = 0.5f + unit(random);
+        float x = (static_cast<float>(i % side) + 0.25f + 0.5f * unit(random)) * spacing - extent * 0.5f;
+        float y = (static_cast<float>(i / side) + 0.25f + 0.5f * unit(random)) * spacing - extent * 0.5f;
+        (*instances)[i] = vsg::vec4(x, y, scale * 0.5f, scale);
+        (*instanceMeshes)[i] = unit(random) < 0.25f ? boxMesh : pyramidMesh;
+    }
+
+    auto occluders = vsg::vec4Array::create(numOccluders);
+    for (uint32_t o = 0; o < numOccluders; ++o)
+    {
+        // the box's half width equals the sphere's radius so the box contains the sphere
+        float radius = spacing * (4.0f + 8.0f * unit(random));
+        float x = (unit(random) - 0.5f) * extent;
+        float y = (unit(random) - 0.5f) * extent;
+        (*occluders)[o] = vsg::vec4(x, y, radius, radius);
+        (*instances)[numInstances + o] = vsg::vec4(x, y, radius, radius * 2.0f);
+        (*instanceMeshes)[numInstances + o] = boxMesh;
+    }
+
+    // set up graphics pipeline
+    vsg::DescriptorSetLayoutBindings descriptorBindings
+    {
+        {0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT, nullptr} // { binding, descriptorTpe, descriptorCount, stageFlags, pImmutableSamplers}
+    };
+
+    auto descriptorSetLayout = vsg::DescriptorSetLayout::create(descriptorBindings);
+
+    vsg::PushConstantRanges pushConstantRanges
+    {
+        {VK_SHADER_STAGE_VERTEX_BIT, 0, 128} // projection view, and model matrices, actual push constant calls autoaatically provided by the VSG's DispatchTraversal
+    };
+
+    // vertex, colour and tex coord arrays, then the per instance position and scale
+    using VertexInputs = vsg::VertexArrays<vsg::vec3, vsg::vec3, vsg::vec2, vsg::vec4>;
+    const uint32_t instanceBinding = 3;
+
+    auto vertexBindings = VertexInputs::bindingDescriptions();
+    vertexBindings[instanceBinding].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
+    vsg::GraphicsPipelineStates pipelineStates
+    {
+        vsg::VertexInputState::create( vertexBindings, VertexInputs::attributeDescriptions() ),
+        vsg::InputAssemblyState::create(),
+        vsg::RasterizationState::create(),
+        vsg::MultisampleState::create(),
+        vsg::ColorBlendState::create(),
+        vsg::DepthStencilState::create()
+    };
+
+    auto pipelineLayout = vsg::PipelineLayout::create(vsg::DescriptorSetLayouts{descriptorSetLayout}, pushConstantRanges);
+    auto graphicsPipeline = vsg::GraphicsPipeline::create(pipelineLayout, vsg::ShaderStages{vertexShader, fragmentShader}, pipelineStates);
+    auto bindGraphicsPipeline = vsg::BindGraphicsPipeline::create(graphicsPipeline);
+
+    // create texture image and associated DescriptorSets and binding
+    auto texture = vsg::DescriptorImage::create(vsg::Sampler::create(), textureData, 0, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+
+    auto descriptorSet = vsg::DescriptorSet::create(descriptorSetLayout, vsg::Descriptors{texture});
+    auto bindDescriptorSet = vsg::BindDescriptorSet::create(VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline->getPipelineLayout(), 0, descriptorSet);
+
+    // create StateGroup as the root of the scene/command graph to hold the GraphicsProgram, and binding of Descriptors to decorate the whole graph
+    auto scenegraph = vsg::StateGroup::create();
+    scenegraph->add(bindGraphicsPipeline);
+    scenegraph->add(bindDescriptorSet);
+
+    // create the viewer and assign window(s) to it
+    auto viewer = vsg::Viewer::create();
+
+    vsg::ref_ptr<vsg::Window> window(vsg::Window::create(width, height, debugLayer, apiDumpLayer));
+    if (!window)
+    {
+        std::cout<<"Could not create windows."<<std::endl;
+        return 1;
+    }
+
+    viewer->addWindow(window);
+
+    // camera related details
+    auto viewport = vsg::ViewportState::create(VkExtent2D{width, height});
+    auto perspective = vsg::Perspective::create(60.0, static_cast<double>(width) / static_cast<double>(height), 1.0, extent * 1.5);
+    auto lookAt = vsg::LookAt::create(vsg::dvec3(0.0, -extent * 0.5, 40.0), vsg::dvec3(0.0, 0.0, 0.0), vsg::dvec3(0.0, 0.0, 1.0));
+    auto camera = vsg::Camera::create(perspective, lookAt, viewport);
+
+    auto drawCommands = vsg::Commands::create();
+    drawCommands->addChild(vsg::createBindIndexBuffer(indices));
+
+    vsg::ref_ptr<vsg::IndirectCulling> culling;
+    if (direct)
+    {
+        // the CPU path for comparison: a DrawIndexed per instance, each reading its position and scale from the instance array
+        drawCommands->addChild(vsg::BindVertexBuffers::create(0, vsg::DataList{vertices, colors, texcoords, instances}));
+        for (uint32_t i = 0; i < instances->valueCount(); ++i)
+        {
+            auto& mesh = meshes[(*instanceMeshes)[i]];
+            drawCommands->addChild(vsg::DrawIndexed::create(mesh.indexCount, 1, mesh.firstIndex, mesh.vertexOffset, i));
+        }
+    }
+    else
+    {
+        // cull the instances in a compute pass and draw the visible ones indirectly, one draw per mesh however many instances there are
+        auto queueFamily = window->physicalDevice()->getQueueFamily(VK_QUEUE_GRAPHICS_BIT);
+        auto transferBatch = vsg::TransferBatch::create(window->device(), queueFamily, instances->dataSize() + instanceMeshes->dataSize() + 1024 * 1024);
+
+        culling = vsg::IndirectCulling::create();
+        culling->meshes = meshes;
+        culling->instances = instances;
+        culling->instanceMeshes = instanceMeshes;
+        culling->occluders = occluders;
+        if (!culling->setup(window->device(), transferBatch, cullShader)) return 1;
+        transferBatch->waitForCompletion();
+
+        drawCommands->addChild(vsg::BindVertexBuffers::create(0, vsg::DataList{vertices, colors, texcoords}));
+        drawCommands->addChild(culling->createDrawCommand(instanceBinding));
+    }
+
+    scenegraph->addChild(drawCommands);
+
+    // assign a CloseHandler to the Viewer to respond to pressing Escape or press the window close button
+    viewer->addEventHandlers({vsg::CloseHandler::create(viewer)});
+
+    viewer->addEventHandler(vsg::Trackball::create(camera));
+
+    auto commandGraph = vsg::createCommandGraphForView(window, camera, scenegraph);
+
+    // compute can't be recorded within a render pass, so the cull goes ahead of the RenderGraph
+    if (culling) commandGraph->getChildren().insert(commandGraph->getChildren().begin(), culling->cullCommands());
+
+    viewer->assignRecordAndSubmitTaskAndPresentation({commandGraph});
+
+    // compile the Vulkan objects
+    viewer->compile();
+
+    double recordTime = 0.0;
+    auto before = std::chrono::steady_clock::now();
+
+    // main frame loop
+    while (viewer->advanceToNextFrame() && (numFrames<0 || (numFrames--)>0))
+    {
+        // pass any events into EventHandlers assigned to the Viewer
+        viewer->handleEvents();
+
+        viewer->update();
+
+        // cull against the view the frame will be rendered with
+        if (culling)
+        {
+            vsg::dmat4 projection, view;
+            perspective->get(projection);
+            lookAt->get(view);
+            culling->setView(projection * view, lookAt->eye);
+        }
+
+        auto recordStart = std::chrono::steady_clock::now();
+
+        viewer->recordAndSubmit();
+
+        recordTime += std::chrono::duration<double, std::chrono::milliseconds::period>(std::chrono::steady_clock::now() - recordStart).count();
+
+        viewer->present();
+    }
+
+    auto runtime = std::chrono::duration<double, std::chrono::seconds::period>(std::chrono::steady_clock::now() - before).count();
+    auto frameCount = static_cast<double>(viewer->getFrameStamp()->frameCount);
+    std::cout << (direct ? "direct" : "indirect") << " drawing of " << instances->valueCount() << " instances" << std::endl;
+    std::cout << "    avg fps: " << frameCount / runtime << ", record and submit " << recordTime / frameCount << "ms/frame" << std::endl;
+
+    if (culling)
+    {
+        vkDeviceWaitIdle(*window->device());
+        culling->report(std::cout);
+    }
+
+    // clean up done automatically thanks to ref_ptr<>
+    return 0;
+}
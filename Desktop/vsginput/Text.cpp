@@ -290,10 +290,7 @@ void GlyphGeometry::compile(Context& context)
         vec3(1.0f, 0.0f, 0.0f)
     });
 
-    auto indices = vsg::ushortArray::create(
-    {
-        0, 1, 2, 3
-    });
+    auto indices = createIndices({0, 1, 2, 3}, indexType(static_cast<uint32_t>(vertices->valueCount()), _indexSupport));
 
 
     DataList dataList;
@@ -302,7 +299,11 @@ void GlyphGeometry::compile(Context& context)
     dataList.emplace_back(_glyphInstances);
     dataList.emplace_back(indices);
 
-    auto bufferData = vsg::createBufferAndTransferData(context, dataList, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE);
+    BufferDataList bufferData;
+    if (_transferBatch)
+        bufferData = _transferBatch->add(dataList, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+    else
+        bufferData = vsg::createBufferAndTransferData(context, dataList, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE);
     if (!bufferData.empty())
     {
         BufferDataList vertexBufferData(bufferData.begin(), bufferData.begin() + 2); //verts and glyph instances
@@ -312,7 +313,7 @@ void GlyphGeometry::compile(Context& context)
         else
             failure = true;
 
-        vsg::ref_ptr<vsg::BindIndexBuffer> bindIndexBuffer = vsg::BindIndexBuffer::create(bufferData.back());
+        vsg::ref_ptr<vsg::Command> bindIndexBuffer = createBindIndexBuffer(bufferData.back());
         if (bindIndexBuffer)
             _renderImplementation.emplace_back(bindIndexBuffer);
         else
@@ -464,6 +465,8 @@ ref_ptr<GlyphGeometry> Text::createInstancedGlyphs()
     // setup geometry
     auto geometry = GlyphGeometry::create();
     geometry->_glyphInstances = instancedata;
+    geometry->_transferBatch = _transferBatch;
+    geometry->_indexSupport = _indexSupport;
 
     return geometry;
 }
@@ -542,6 +545,8 @@ ref_ptr<GlyphGeometry> TextGroup::createInstancedGlyphs()
 
     auto geometry = GlyphGeometry::create();
     geometry->_glyphInstances = instancedata;
+    geometry->_transferBatch = _transferBatch;
+    geometry->_indexSupport = _indexSupport;
 
     return geometry;
 }
@@ -1,5 +1,8 @@
 #include <vsg/all.h>
 
+#include "GeometryBuilder.h"
+#include "TransferBatch.h"
+
 namespace vsg
 {
     class GraphicsPipelineBuilder : public Inherit<Object, GraphicsPipelineBuilder>
@@ -140,6 +143,8 @@ namespace vsg
 
         // settings
         ref_ptr<Data> _glyphInstances;
+        ref_ptr<TransferBatch> _transferBatch; // optional, when assigned uploads are batched rather than using the Context's staging buffers
+        IndexSupport _indexSupport;            // index limits of the device, the quad's indices are only 8 bit when its uint8 is set
 
         using Commands = std::vector<ref_ptr<Command>>;
 
@@ -167,6 +172,12 @@ namespace vsg
 
         void setPosition(const vec3& position);
 
+        TransferBatch* getTransferBatch() const { return _transferBatch; }
+        void setTransferBatch(TransferBatch* transferBatch) { _transferBatch = transferBatch; }
+
+        const IndexSupport& getIndexSupport() const { return _indexSupport; }
+        void setIndexSupport(const IndexSupport& indexSupport) { _indexSupport = indexSupport; }
+
         void buildTextGraph();
 
     protected:
@@ -175,6 +186,8 @@ namespace vsg
         // data
         ref_ptr<Font> _font;
         ref_ptr<TextMetricsValue> _textMetrics;
+        ref_ptr<TransferBatch> _transferBatch;
+        IndexSupport _indexSupport;
 
         // graph objects
         ref_ptr<DescriptorBuffer> _textMetricsUniform;
@@ -8,7 +8,7 @@
 class KeyboardInput : public vsg::Inherit<vsg::Visitor, KeyboardInput>
 {
 public:
-    KeyboardInput(vsg::ref_ptr<vsg::Viewer> viewer, vsg::ref_ptr<vsg::Group> root, vsg::Paths searchPaths) :
+    KeyboardInput(vsg::ref_ptr<vsg::Viewer> viewer, vsg::ref_ptr<vsg::Group> root, vsg::Paths searchPaths, vsg::ref_ptr<vsg::TransferBatch> transferBatch = {}) :
         _viewer(viewer),
         _root(root),
         _shouldRecompile(false)
@@ -29,9 +29,13 @@ public:
         stategroup->add(_font);
 
         _keyboardInputText = vsg::Text::create(_font, textPipelineBuilder->getGraphicsPipeline());
+        _keyboardInputText->setTransferBatch(transferBatch);
+        _keyboardInputText->setIndexSupport(vsg::IndexSupport::from(window->physicalDevice()));
         stategroup->addChild(_keyboardInputText);
 
         _textGroup = vsg::TextGroup::create(_font, textPipelineBuilder->getGraphicsPipeline());
+        _textGroup->setTransferBatch(transferBatch);
+        _textGroup->setIndexSupport(vsg::IndexSupport::from(window->physicalDevice()));
         stategroup->addChild(_textGroup);
 
         //
@@ -181,6 +185,7 @@ int main(int argc, char** argv)
     auto debugLayer = arguments.read({"--debug","-d"});
     auto apiDumpLayer = arguments.read({"--api","-a"});
     auto usePerspective = arguments.read({ "--perspective","-p" });
+    auto batchTransfers = arguments.read("--batch-transfers");
     auto [width, height] = arguments.value(std::pair<uint32_t, uint32_t>(800, 600), {"--window", "-w"});
     if (arguments.errors()) return arguments.writeErrorMessages(std::cerr);
 
@@ -211,6 +216,14 @@ int main(int argc, char** argv)
 
     viewer->addWindow(window);
 
+    // optionally batch all the glyph geometry uploads into a single submission per compile
+    vsg::ref_ptr<vsg::TransferBatch> transferBatch;
+    if (batchTransfers)
+    {
+        auto queueFamily = window->physicalDevice()->getQueueFamily(VK_QUEUE_GRAPHICS_BIT);
+        transferBatch = vsg::TransferBatch::create(window->device(), queueFamily);
+    }
+
     // camera related details
     auto viewport = vsg::ViewportState::create(VkExtent2D{width, height});
 
@@ -230,7 +243,7 @@ int main(int argc, char** argv)
     auto camera = vsg::Camera::create(projection, lookAt, viewport);
 
     // keyboard input for demo
-    vsg::ref_ptr<KeyboardInput> keyboardInput = KeyboardInput::create(viewer, scenegraph, searchPaths);
+    vsg::ref_ptr<KeyboardInput> keyboardInput = KeyboardInput::create(viewer, scenegraph, searchPaths, transferBatch);
 
     // assign a CloseHandler to the Viewer to respond to pressing Escape or press the window close button
     viewer->addEventHandlers({vsg::CloseHandler::create(viewer), keyboardInput});
@@ -242,6 +255,7 @@ int main(int argc, char** argv)
 
     // compile the Vulkan objects
     viewer->compile();
+    if (transferBatch) transferBatch->flush();
 
     auto before = std::chrono::steady_clock::now();
 
@@ -257,8 +271,12 @@ int main(int argc, char** argv)
         {
             keyboardInput->reset(); // this releases the graphicspipline implementation
             viewer->compile();
+            if (transferBatch) transferBatch->flush();
         }
 
+        // release staging space of any completed uploads
+        if (transferBatch) transferBatch->collect();
+
         viewer->recordAndSubmit();
 
         viewer->present();
@@ -267,6 +285,8 @@ int main(int argc, char** argv)
     auto runtime = std::chrono::duration<double, std::chrono::seconds::period>(std::chrono::steady_clock::now() - before).count();
     std::cout << "avg fps: " << 1.0 / (runtime / (double)viewer->getFrameStamp()->frameCount) <<std::endl;
 
+    if (transferBatch) transferBatch->report(std::cout);
+
     // clean up done automatically thanks to ref_ptr<>
     return 0;
 }
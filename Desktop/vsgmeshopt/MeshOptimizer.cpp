@@ -0,0 +1,655 @@
+#include "MeshOptimizer.h"
+#include "GeometryBuilder.h"
+#include "VertexLayout.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <unordered_map>
+
+using namespace vsg;
+
+namespace
+{
+    // SPIR-V opcodes and enums used by vertexInputLocations()
+    constexpr uint32_t SpvMagicNumber = 0x07230203;
+    constexpr uint32_t SpvOpTypeMatrix = 24;
+    constexpr uint32_t SpvOpTypeArray = 28;
+    constexpr uint32_t SpvOpTypeRuntimeArray = 29;
+    constexpr uint32_t SpvOpTypePointer = 32;
+    constexpr uint32_t SpvOpVariable = 59;
+    constexpr uint32_t SpvOpDecorate = 71;
+    constexpr uint32_t SpvDecorationLocation = 30;
+    constexpr uint32_t SpvStorageClassInput = 1;
+
+    // upper bound of VkPhysicalDeviceLimits::maxVertexInputAttributes on current hardware
+    constexpr uint32_t maxVertexInputLocations = 64;
+
+    constexpr uint32_t invalidIndex = std::numeric_limits<uint32_t>::max();
+
+    using Replacements = std::map<Data*, ref_ptr<Data>>;
+
+    // the vertex input state, topology and shader inputs of a GraphicsPipeline
+    struct PipelineInputs
+    {
+        VertexInputState* vertexInputState = nullptr;
+        VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+        bool locationsKnown = false;
+        std::set<uint32_t> locations;
+    };
+
+    struct Mesh
+    {
+        ref_ptr<VertexIndexDraw> draw;
+        const PipelineInputs* inputs = nullptr;
+    };
+
+    struct CollectMeshes : public Visitor
+    {
+        std::map<GraphicsPipeline*, PipelineInputs> pipelines;
+        std::vector<Mesh> meshes;
+        std::map<const Data*, size_t> uses;
+        std::set<VertexInputState*> otherDraws; // states also used by Geometry or BindVertexBuffers, which can't be stripped
+        std::set<Data*> otherArrays;
+        std::vector<ref_ptr<Objects>> userObjects;
+
+        void collectUserObjects(Object& object)
+        {
+            auto auxiliary = object.getAuxiliary();
+            if (!auxiliary) return;
+
+            for (auto& entry : auxiliary->getObjectMap())
+            {
+                auto objects = dynamic_cast<Objects*>(entry.second.get());
+                if (objects && _visitedObjects.insert(objects).second) userObjects.emplace_back(objects);
+            }
+        }
+
+        const PipelineInputs& pipelineInputs(GraphicsPipeline& pipeline)
+        {
+            auto [itr, inserted] = pipelines.try_emplace(&pipeline);
+            auto& inputs = itr->second;
+            if (!inserted) return inputs;
+
+            for (auto& state : pipeline.pipelineStates)
+            {
+                if (auto vertexInputState = dynamic_cast<VertexInputState*>(state.get())) inputs.vertexInputState = vertexInputState;
+                else if (auto inputAssemblyState = dynamic_cast<InputAssemblyState*>(state.get())) inputs.topology = inputAssemblyState->topology;
+            }
+
+            for (auto& stage : pipeline.stages)
+            {
+                if (stage && stage->stage == VK_SHADER_STAGE_VERTEX_BIT && stage->module)
+                {
+                    inputs.locationsKnown = vertexInputLocations(stage->module->code, inputs.locations);
+                }
+            }
+            return inputs;
+        }
+
+        void addOther(const DataList& arrays)
+        {
+            if (_current && _current->vertexInputState) otherDraws.insert(_current->vertexInputState);
+            for (auto& array : arrays)
+            {
+                ++uses[array.get()];
+                otherArrays.insert(array.get());
+            }
+        }
+
+        void apply(Object& object) override
+        {
+            collectUserObjects(object);
+        }
+
+        void apply(Node& node) override
+        {
+            collectUserObjects(node);
+            node.traverse(*this);
+        }
+
+        void apply(StateGroup& stateGroup) override
+        {
+            collectUserObjects(stateGroup);
+
+            auto saved = _current;
+            for (auto& stateCommand : stateGroup.getStateCommands())
+            {
+                auto bindPipeline = dynamic_cast<BindGraphicsPipeline*>(stateCommand.get());
+                if (bindPipeline && bindPipeline->pipeline) _current = &pipelineInputs(*bindPipeline->pipeline);
+            }
+
+            stateGroup.traverse(*this);
+
+            _current = saved;
+        }
+
+        void apply(VertexIndexDraw& draw) override
+        {
+            collectUserObjects(draw);
+
+            // subgraphs can be shared, only count the draw's arrays once
+            if (!_visitedDraws.insert(&draw).second) return;
+
+            meshes.push_back(Mesh{ref_ptr<VertexIndexDraw>(&draw), _current});
+            for (auto& array : draw.arrays) ++uses[array.get()];
+            if (draw.indices) ++uses[draw.indices.get()];
+        }
+
+        void apply(Geometry& geometry) override
+        {
+            collectUserObjects(geometry);
+            addOther(geometry.arrays);
+            if (geometry.indices)
+            {
+                ++uses[geometry.indices.get()];
+                otherArrays.insert(geometry.indices.get());
+            }
+            geometry.traverse(*this);
+        }
+
+        void apply(BindVertexBuffers& bvb) override
+        {
+            collectUserObjects(bvb);
+            addOther(bvb.getArrays());
+        }
+
+    protected:
+        const PipelineInputs* _current = nullptr;
+        std::set<VertexIndexDraw*> _visitedDraws;
+        std::set<Objects*> _visitedObjects;
+    };
+
+    // index array of the same type as like
+    ref_ptr<Data> createIndicesLike(const Data* like, const std::vector<uint32_t>& values)
+    {
+        auto size = static_cast<uint32_t>(values.size());
+        ref_ptr<Data> indices;
+        if (dynamic_cast<const ushortArray*>(like)) indices = ushortArray::create(size);
+        else if (dynamic_cast<const uintArray*>(like)) indices = uintArray::create(size);
+        else if (dynamic_cast<const ubyteArray*>(like)) indices = ubyteArray::create(size);
+
+        if (indices) writeIndices(indices, values);
+        return indices;
+    }
+
+    // per vertex view of an array for comparing vertices, float arrays are compared within a tolerance, others exactly
+    struct VertexView
+    {
+        const uint8_t* data = nullptr;
+        size_t stride = 0;
+        bool isFloat = false;
+
+        explicit VertexView(const Data* array) :
+            data(static_cast<const uint8_t*>(array->dataPointer())),
+            stride(array->dataSize() / array->valueCount()),
+            isFloat(dynamic_cast<const floatArray*>(array) || dynamic_cast<const vec2Array*>(array) || dynamic_cast<const vec3Array*>(array) || dynamic_cast<const vec4Array*>(array))
+        {
+        }
+
+        bool equal(uint32_t a, uint32_t b, float tolerance) const
+        {
+            const uint8_t* lhs = data + a * stride;
+            const uint8_t* rhs = data + b * stride;
+            if (!isFloat) return std::memcmp(lhs, rhs, stride) == 0;
+
+            for (size_t offset = 0; offset < stride; offset += sizeof(float))
+            {
+                float l, r;
+                std::memcpy(&l, lhs + offset, sizeof(float));
+                std::memcpy(&r, rhs + offset, sizeof(float));
+                if (!(std::abs(l - r) <= tolerance)) return false;
+            }
+            return true;
+        }
+    };
+
+    // map each vertex to the first earlier vertex with the same position, within tolerance of the bounds diagonal, and the same attributes.
+    // Positions are bucketed in a spatial hash with cells at least the tolerance wide, so matching vertices are always in neighbouring cells.
+    std::vector<uint32_t> weldVertices(const DataList& arrays, double tolerance, float attributeTolerance)
+    {
+        uint32_t numVertices = arrays.front()->valueCount();
+        std::vector<uint32_t> remap(numVertices);
+        for (uint32_t i = 0; i < numVertices; ++i) remap[i] = i;
+
+        auto vertices = dynamic_cast<const vec3Array*>(arrays.front().get());
+        if (!vertices || numVertices == 0) return remap;
+
+        box bounds;
+        for (auto& v : *vertices) bounds.add(v);
+        double diagonal = length(bounds.max - bounds.min);
+
+        double positionTolerance = tolerance * diagonal;
+        double cellSize = std::max(positionTolerance, diagonal > 0.0 ? diagonal * 1e-6 : 1.0);
+
+        std::vector<VertexView> attributes;
+        for (size_t i = 1; i < arrays.size(); ++i) attributes.emplace_back(arrays[i].get());
+
+        auto cell = [&](const vec3& v) {
+            return dvec3{std::floor((v.x - bounds.min.x) / cellSize), std::floor((v.y - bounds.min.y) / cellSize), std::floor((v.z - bounds.min.z) / cellSize)};
+        };
+
+        auto cellKey = [](double x, double y, double z) {
+            return (static_cast<uint64_t>(static_cast<int64_t>(x)) * 73856093ull) ^ (static_cast<uint64_t>(static_cast<int64_t>(y)) * 19349663ull) ^ (static_cast<uint64_t>(static_cast<int64_t>(z)) * 83492791ull);
+        };
+
+        auto matches = [&](uint32_t a, uint32_t b) {
+            const vec3& va = (*vertices)[a];
+            const vec3& vb = (*vertices)[b];
+            if (std::abs(double(va.x) - double(vb.x)) > positionTolerance || std::abs(double(va.y) - double(vb.y)) > positionTolerance || std::abs(double(va.z) - double(vb.z)) > positionTolerance) return false;
+            for (auto& attribute : attributes)
+            {
+                if (!attribute.equal(a, b, attributeTolerance)) return false;
+            }
+            return true;
+        };
+
+        // cells hold linked lists of the unique vertices, hash collisions just lengthen the lists
+        std::unordered_map<uint64_t, uint32_t> cellHeads;
+        cellHeads.reserve(numVertices);
+        std::vector<uint32_t> next(numVertices, invalidIndex);
+
+        for (uint32_t v = 0; v < numVertices; ++v)
+        {
+            auto c = cell((*vertices)[v]);
+            uint32_t match = invalidIndex;
+            for (int dz = -1; dz <= 1 && match == invalidIndex; ++dz)
+            {
+                for (int dy = -1; dy <= 1 && match == invalidIndex; ++dy)
+                {
+                    for (int dx = -1; dx <= 1 && match == invalidIndex; ++dx)
+                    {
+                        auto itr = cellHeads.find(cellKey(c.x + dx, c.y + dy, c.z + dz));
+                        if (itr == cellHeads.end()) continue;
+
+                        for (uint32_t u = itr->second; u != invalidIndex; u = next[u])
+                        {
+                            if (matches(u, v))
+                            {
+                                match = u;
+                                break;
+                            }
+                        }
+                    }
+                }
+            }
+
+            if (match != invalidIndex)
+            {
+                remap[v] = match;
+            }
+            else
+            {
+                auto [itr, inserted] = cellHeads.try_emplace(cellKey(c.x, c.y, c.z), v);
+                if (!inserted)
+                {
+                    next[v] = itr->second;
+                    itr->second = v;
+                }
+            }
+        }
+        return remap;
+    }
+
+    struct MeshResult
+    {
+        size_t numTriangles = 0;
+        double acmrBefore = 0.0;
+        double acmrAfter = 0.0;
+    };
+
+    bool optimizeMesh(const MeshOptimizer& settings, VertexIndexDraw& draw, const PipelineInputs* inputs, Replacements& replacements, MeshResult& result)
+    {
+        if (inputs && inputs->topology != VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST) return false;
+        if (draw.arrays.empty() || !draw.indices || draw.firstIndex != 0 || draw.vertexOffset != 0) return false;
+
+        // per instance arrays aren't indexed by vertex
+        if (inputs && inputs->vertexInputState)
+        {
+            for (auto& binding : inputs->vertexInputState->vertexBindingDescriptions)
+            {
+                if (binding.inputRate != VK_VERTEX_INPUT_RATE_VERTEX) return false;
+            }
+        }
+
+        auto indices = readIndices(draw.indices);
+        if (indices.empty() || indices.size() % 3 != 0 || draw.indexCount != indices.size()) return false;
+
+        uint32_t numVertices = draw.arrays.front() ? draw.arrays.front()->valueCount() : 0;
+        for (auto& array : draw.arrays)
+        {
+            if (!array || array->valueCount() != numVertices || !remapArray(array, {})) return false;
+        }
+        for (auto index : indices)
+        {
+            if (index >= numVertices) return false;
+        }
+
+        result.acmrBefore = computeACMR(indices, numVertices, settings.cacheSize);
+
+        if (settings.weld)
+        {
+            auto remap = weldVertices(draw.arrays, settings.weldTolerance, settings.attributeTolerance);
+            for (auto& index : indices) index = remap[index];
+
+            // welding can collapse small triangles
+            size_t numIndices = 0;
+            for (size_t i = 0; i < indices.size(); i += 3)
+            {
+                uint32_t a = indices[i], b = indices[i + 1], c = indices[i + 2];
+                if (a == b || b == c || c == a) continue;
+                indices[numIndices++] = a;
+                indices[numIndices++] = b;
+                indices[numIndices++] = c;
+            }
+            indices.resize(numIndices);
+        }
+
+        if (settings.reorderTriangles) indices = tipsify(indices, numVertices, settings.cacheSize);
+
+        // keep only the referenced vertices, either in first use order or their original order
+        std::vector<uint32_t> oldToNew(numVertices, invalidIndex);
+        std::vector<uint32_t> newToOld;
+        newToOld.reserve(numVertices);
+        if (settings.reorderVertices)
+        {
+            for (auto index : indices)
+            {
+                if (oldToNew[index] != invalidIndex) continue;
+                oldToNew[index] = static_cast<uint32_t>(newToOld.size());
+                newToOld.push_back(index);
+            }
+        }
+        else
+        {
+            std::vector<bool> referenced(numVertices, false);
+            for (auto index : indices) referenced[index] = true;
+            for (uint32_t v = 0; v < numVertices; ++v)
+            {
+                if (!referenced[v]) continue;
+                oldToNew[v] = static_cast<uint32_t>(newToOld.size());
+                newToOld.push_back(v);
+            }
+        }
+        for (auto& index : indices) index = oldToNew[index];
+
+        result.numTriangles = indices.size() / 3;
+        result.acmrAfter = computeACMR(indices, static_cast<uint32_t>(newToOld.size()), settings.cacheSize);
+
+        for (auto& array : draw.arrays)
+        {
+            auto remapped = remapArray(array, newToOld);
+            replacements[array.get()] = remapped;
+            array = remapped;
+        }
+
+        if (indices.size() == draw.indices->valueCount())
+        {
+            writeIndices(draw.indices, indices);
+        }
+        else
+        {
+            auto newIndices = createIndicesLike(draw.indices, indices);
+            replacements[draw.indices.get()] = newIndices;
+            draw.indices = newIndices;
+            draw.indexCount = static_cast<uint32_t>(indices.size());
+        }
+        return true;
+    }
+
+    size_t dataSize(const std::vector<Mesh>& meshes)
+    {
+        std::set<const Data*> arrays;
+        for (auto& mesh : meshes)
+        {
+            for (auto& array : mesh.draw->arrays) arrays.insert(array.get());
+            arrays.insert(mesh.draw->indices.get());
+        }
+
+        size_t size = 0;
+        for (auto array : arrays)
+        {
+            if (array) size += array->dataSize();
+        }
+        return size;
+    }
+} // namespace
+
+bool vsg::vertexInputLocations(const std::vector<uint32_t>& spirv, std::set<uint32_t>& locations)
+{
+    if (spirv.size() < 5 || spirv[0] != SpvMagicNumber) return false;
+
+    std::map<uint32_t, uint32_t> locationOf;  // variable id to location
+    std::map<uint32_t, uint32_t> pointeeOf;   // pointer type id to the type pointed to
+    std::set<uint32_t> aggregateTypes;        // matrix and array type ids
+    std::vector<std::pair<uint32_t, uint32_t>> inputs; // Input variable id and its pointer type id
+
+    for (size_t i = 5; i < spirv.size();)
+    {
+        uint32_t opcode = spirv[i] & 0xffff;
+        uint32_t wordCount = spirv[i] >> 16;
+        if (wordCount == 0 || i + wordCount > spirv.size()) return false;
+
+        const uint32_t* operands = &spirv[i + 1];
+        switch (opcode)
+        {
+        case SpvOpDecorate:
+            if (wordCount >= 4 && operands[1] == SpvDecorationLocation) locationOf[operands[0]] = operands[2];
+            break;
+        case SpvOpTypePointer:
+            if (wordCount >= 4) pointeeOf[operands[0]] = operands[2];
+            break;
+        case SpvOpTypeMatrix:
+        case SpvOpTypeArray:
+        case SpvOpTypeRuntimeArray:
+            if (wordCount >= 2) aggregateTypes.insert(operands[0]);
+            break;
+        case SpvOpVariable:
+            if (wordCount >= 4 && operands[2] == SpvStorageClassInput) inputs.emplace_back(operands[1], operands[0]);
+            break;
+        default:
+            break;
+        }
+        i += wordCount;
+    }
+
+    // built in inputs such as gl_VertexIndex have no location
+    for (auto& [variable, pointerType] : inputs)
+    {
+        auto location = locationOf.find(variable);
+        if (location == locationOf.end()) continue;
+
+        auto pointee = pointeeOf.find(pointerType);
+        bool aggregate = pointee != pointeeOf.end() && aggregateTypes.count(pointee->second) != 0;
+
+        if (aggregate)
+        {
+            for (uint32_t l = location->second; l < maxVertexInputLocations; ++l) locations.insert(l);
+        }
+        else
+        {
+            locations.insert(location->second);
+        }
+    }
+    return true;
+}
+
+MeshOptimizer::MeshOptimizer()
+{
+}
+
+void MeshOptimizer::optimize(Object& object)
+{
+    numMeshes = 0;
+    numSkippedMeshes = 0;
+    numVerticesBefore = 0;
+    numVerticesAfter = 0;
+    numTrianglesBefore = 0;
+    numTrianglesAfter = 0;
+    numStrippedArrays = 0;
+    acmrBefore = 0.0;
+    acmrAfter = 0.0;
+
+    CollectMeshes collect;
+    object.accept(collect);
+
+    dataSizeBefore = dataSize(collect.meshes);
+    for (auto& mesh : collect.meshes)
+    {
+        if (!mesh.draw->arrays.empty() && mesh.draw->arrays.front()) numVerticesBefore += mesh.draw->arrays.front()->valueCount();
+        numTrianglesBefore += mesh.draw->indexCount / 3;
+    }
+
+    Replacements replacements;
+
+    if (stripUnusedAttributes)
+    {
+        // pipelines can share a VertexInputState, so only strip the bindings none of their vertex shaders read
+        std::map<VertexInputState*, std::pair<bool, std::set<uint32_t>>> readLocations;
+        for (auto& [pipeline, inputs] : collect.pipelines)
+        {
+            if (!inputs.vertexInputState) continue;
+            auto [itr, inserted] = readLocations.try_emplace(inputs.vertexInputState, true, std::set<uint32_t>());
+            itr->second.first = itr->second.first && inputs.locationsKnown;
+            itr->second.second.insert(inputs.locations.begin(), inputs.locations.end());
+        }
+
+        for (auto& [vertexInputState, read] : readLocations)
+        {
+            auto& [locationsKnown, locations] = read;
+            if (!locationsKnown || collect.otherDraws.count(vertexInputState) != 0) continue;
+
+            auto& bindings = vertexInputState->vertexBindingDescriptions;
+            auto& attributes = vertexInputState->vertexAttributeDescriptions;
+
+            std::set<uint32_t> unusedBindings;
+            for (auto& binding : bindings)
+            {
+                bool used = std::any_of(attributes.begin(), attributes.end(), [&](const VkVertexInputAttributeDescription& attribute) {
+                    return attribute.binding == binding.binding && locations.count(attribute.location) != 0;
+                });
+                if (!used) unusedBindings.insert(binding.binding);
+            }
+            if (unusedBindings.empty()) continue;
+
+            // bindings are renumbered after stripping, which is only consistent if every draw binds its arrays from binding 0
+            std::vector<VertexIndexDraw*> draws;
+            bool firstBindingZero = true;
+            for (auto& mesh : collect.meshes)
+            {
+                if (!mesh.inputs || mesh.inputs->vertexInputState != vertexInputState) continue;
+                draws.push_back(mesh.draw.get());
+                firstBindingZero = firstBindingZero && mesh.draw->firstBinding == 0;
+            }
+            if (!firstBindingZero) continue;
+
+            for (auto draw : draws)
+            {
+                DataList arrays;
+                for (uint32_t i = 0; i < draw->arrays.size(); ++i)
+                {
+                    if (unusedBindings.count(i) != 0)
+                    {
+                        replacements[draw->arrays[i].get()] = {};
+                        ++numStrippedArrays;
+                    }
+                    else
+                    {
+                        arrays.push_back(draw->arrays[i]);
+                    }
+                }
+                draw->arrays = arrays;
+            }
+
+            auto renumber = [&](uint32_t binding) {
+                return binding - static_cast<uint32_t>(std::distance(unusedBindings.begin(), unusedBindings.lower_bound(binding)));
+            };
+
+            VertexInputState::Bindings strippedBindings;
+            for (auto& binding : bindings)
+            {
+                if (unusedBindings.count(binding.binding) != 0) continue;
+                strippedBindings.push_back(binding);
+                strippedBindings.back().binding = renumber(binding.binding);
+            }
+
+            VertexInputState::Attributes strippedAttributes;
+            for (auto& attribute : attributes)
+            {
+                if (unusedBindings.count(attribute.binding) != 0) continue;
+                strippedAttributes.push_back(attribute);
+                strippedAttributes.back().binding = renumber(attribute.binding);
+            }
+
+            bindings = strippedBindings;
+            attributes = strippedAttributes;
+        }
+    }
+
+    size_t numOptimizedTriangles = 0;
+    for (auto& mesh : collect.meshes)
+    {
+        auto& draw = *mesh.draw;
+
+        bool shared = collect.uses[draw.indices.get()] > 1;
+        for (auto& array : draw.arrays) shared = shared || collect.uses[array.get()] > 1;
+
+        MeshResult result;
+        if (!shared && optimizeMesh(*this, draw, mesh.inputs, replacements, result))
+        {
+            ++numMeshes;
+            acmrBefore += result.acmrBefore * double(result.numTriangles);
+            acmrAfter += result.acmrAfter * double(result.numTriangles);
+            numTrianglesAfter += result.numTriangles;
+            numOptimizedTriangles += result.numTriangles;
+        }
+        else
+        {
+            ++numSkippedMeshes;
+            numTrianglesAfter += draw.indexCount / 3;
+        }
+
+        if (!draw.arrays.empty() && draw.arrays.front()) numVerticesAfter += draw.arrays.front()->valueCount();
+    }
+
+    if (numOptimizedTriangles > 0)
+    {
+        acmrBefore /= double(numOptimizedTriangles);
+        acmrAfter /= double(numOptimizedTriangles);
+    }
+
+    dataSizeAfter = dataSize(collect.meshes);
+
+    // update the user object lists holding the old arrays, stripped arrays are removed unless something else still uses them
+    std::set<const Data*> referenced(collect.otherArrays.begin(), collect.otherArrays.end());
+    for (auto& mesh : collect.meshes)
+    {
+        for (auto& array : mesh.draw->arrays) referenced.insert(array.get());
+        referenced.insert(mesh.draw->indices.get());
+    }
+
+    for (auto& objects : collect.userObjects)
+    {
+        Objects::Children children;
+        for (auto& child : objects->getChildren())
+        {
+            auto data = dynamic_cast<Data*>(child.get());
+            auto itr = data ? replacements.find(data) : replacements.end();
+            if (itr == replacements.end() || referenced.count(data) != 0) children.push_back(child);
+            else if (itr->second) children.push_back(itr->second);
+        }
+        objects->getChildren() = children;
+    }
+}
+
+void MeshOptimizer::report(std::ostream& out) const
+{
+    out << "MeshOptimizer " << numMeshes << " meshes optimized, " << numSkippedMeshes << " skipped" << std::endl;
+    out << "    vertices " << numVerticesBefore << " before, " << numVerticesAfter << " after" << std::endl;
+    out << "    triangles " << numTrianglesBefore << " before, " << numTrianglesAfter << " after" << std::endl;
+    out << "    vertex arrays stripped " << numStrippedArrays << std::endl;
+    out << "    vertex and index data " << dataSizeBefore << " bytes before, " << dataSizeAfter << " bytes after" << std::endl;
+    out << "    ACMR with " << cacheSize << " entry cache " << acmrBefore << " before, " << acmrAfter << " after" << std::endl;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vsg/all.h>
+
+#include <ostream>
+#include <set>
+#include <vector>
+
+namespace vsg
+{
+
+    // the locations of the Input variables declared by a vertex shader's SPIR-V, array and matrix inputs mark every location from
+    // theirs upwards as used. Returns false if the code isn't valid SPIR-V.
+    bool vertexInputLocations(const std::vector<uint32_t>& spirv, std::set<uint32_t>& locations);
+
+    //
+    // MeshOptimizer optimizes the triangle list VertexIndexDraw meshes of a loaded scene graph for the GPU:
+    //
+    //   welds duplicate vertices, found with a spatial hash on the vertex positions then compared on every attribute,
+    //   reorders triangles for the post transform vertex cache with Tipsify,
+    //   reorders vertices into first use order so vertex fetches walk through memory,
+    //   strips vertex arrays that the pipeline's vertex shader doesn't read, updating the pipeline's VertexInputState.
+    //
+    // Meshes whose arrays or indices are shared with other draws, or that draw a sub range of their indices, are left unchanged.
+    // vsg::Objects held as user objects, as the "batch" of the vsgXchange loaders, are updated to refer to the new arrays.
+    //
+    class MeshOptimizer : public Inherit<Object, MeshOptimizer>
+    {
+    public:
+        MeshOptimizer();
+
+        bool weld = true;
+        double weldTolerance = 1e-6; // fraction of the mesh's bounding box diagonal
+        float attributeTolerance = 1e-4f;
+        bool reorderTriangles = true;
+        bool reorderVertices = true;
+        bool stripUnusedAttributes = true;
+        uint32_t cacheSize = 16;
+
+        void optimize(Object& object);
+
+        void report(std::ostream& out) const;
+
+        // stats from the last optimize, sizes in bytes of the vertex and index arrays
+        size_t numMeshes = 0;
+        size_t numSkippedMeshes = 0;
+        size_t numVerticesBefore = 0;
+        size_t numVerticesAfter = 0;
+        size_t numTrianglesBefore = 0;
+        size_t numTrianglesAfter = 0;
+        size_t numStrippedArrays = 0;
+        size_t dataSizeBefore = 0;
+        size_t dataSizeAfter = 0;
+        double acmrBefore = 0.0; // triangle weighted average over the optimized meshes
+        double acmrAfter = 0.0;
+    };
+    VSG_type_name(MeshOptimizer)
+
+} // namespace vsg
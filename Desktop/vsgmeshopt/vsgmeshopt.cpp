@@ -0,0 +1,65 @@
+#include <vsg/all.h>
+
+#include <fstream>
+#include <iostream>
+
+#include "MeshOptimizer.h"
+
+// size of a file in bytes, 0 if it can't be opened
+std::streamoff fileSize(const vsg::Path& filename)
+{
+    std::ifstream fin(filename, std::ios::binary | std::ios::ate);
+    return fin ? static_cast<std::streamoff>(fin.tellg()) : 0;
+}
+
+int main(int argc, char** argv)
+{
+    // set up defaults and read command line arguments to override them
+    vsg::CommandLine arguments(&argc, argv);
+
+    auto optimizer = vsg::MeshOptimizer::create();
+    optimizer->weld = !arguments.read("--no-weld");
+    optimizer->weldTolerance = arguments.value(optimizer->weldTolerance, {"--weld-tolerance", "-t"});
+    optimizer->attributeTolerance = arguments.value(optimizer->attributeTolerance, "--attribute-tolerance");
+    optimizer->reorderTriangles = !arguments.read("--no-triangle-reorder");
+    optimizer->reorderVertices = !arguments.read("--no-vertex-reorder");
+    optimizer->stripUnusedAttributes = !arguments.read("--no-strip");
+    optimizer->cacheSize = arguments.value(optimizer->cacheSize, {"--cache-size", "-c"});
+
+    if (arguments.errors()) return arguments.writeErrorMessages(std::cerr);
+
+    if (argc != 3)
+    {
+        std::cout<<"Usage: vsgmeshopt input.vsgt output.vsgb [--weld-tolerance ratio] [--attribute-tolerance value] [--cache-size entries]"<<std::endl;
+        std::cout<<"                  [--no-weld] [--no-triangle-reorder] [--no-vertex-reorder] [--no-strip]"<<std::endl;
+        return 1;
+    }
+
+    vsg::Path inputFilename = arguments[1];
+    vsg::Path outputFilename = arguments[2];
+
+    if (vsg::fileExtension(outputFilename) != "vsgb")
+    {
+        std::cout<<"Warning: output file "<<outputFilename<<" is not a .vsgb, it will be written in the format of its extension."<<std::endl;
+    }
+
+    auto object = vsg::read(inputFilename);
+    if (!object)
+    {
+        std::cout<<"Warning: file not read : "<<inputFilename<<std::endl;
+        return 1;
+    }
+
+    optimizer->optimize(*object);
+
+    if (!vsg::write(object, outputFilename))
+    {
+        std::cout<<"Warning: file not written : "<<outputFilename<<std::endl;
+        return 1;
+    }
+
+    optimizer->report(std::cout);
+    std::cout<<"    file size "<<fileSize(inputFilename)<<" bytes "<<inputFilename<<", "<<fileSize(outputFilename)<<" bytes "<<outputFilename<<std::endl;
+
+    return 0;
+}
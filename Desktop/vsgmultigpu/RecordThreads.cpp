@@ -0,0 +1,114 @@
+#include "RecordThreads.h"
+
+#include <algorithm>
+#include <chrono>
+
+using namespace vsg;
+
+RecordThreads::RecordThreads(Viewer* viewer, const std::vector<Affinity>& affinities) :
+    _viewer(viewer)
+{
+    auto& tasks = _viewer->recordAndSubmitTasks;
+
+    recordTimes.assign(tasks.size(), 0.0);
+    maxRecordTimes.assign(tasks.size(), 0.0);
+
+    for (auto& task : tasks)
+    {
+        _submitMutexes.push_back(&_queueMutexes[task->queue.get()]);
+    }
+
+    for (size_t i = 0; i < tasks.size(); ++i)
+    {
+        _threads.emplace_back(&RecordThreads::run, this, i, i < affinities.size() ? affinities[i] : Affinity());
+    }
+}
+
+RecordThreads::~RecordThreads()
+{
+    {
+        std::scoped_lock<std::mutex> lock(_mutex);
+        _done = true;
+    }
+    _startCondition.notify_all();
+
+    for (auto& thread : _threads) thread.join();
+}
+
+void RecordThreads::run(size_t index, Affinity affinity)
+{
+    if (affinity) setAffinity(affinity);
+
+    uint64_t frame = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _startCondition.wait(lock, [&]() { return _done || _frame != frame; });
+            if (_done) return;
+            frame = _frame;
+        }
+
+        // record in parallel with the other threads, only the submission to a shared queue needs to be serialized.
+        // Only record() is timed, so the fence wait in start() and waiting on the queue mutex aren't counted as recording.
+        auto& task = _viewer->recordAndSubmitTasks[index];
+        CommandBuffers recordedCommandBuffers;
+        double time = 0.0;
+        if (task->start() == VK_SUCCESS)
+        {
+            auto start = std::chrono::steady_clock::now();
+            auto result = task->record(recordedCommandBuffers, _viewer->getFrameStamp());
+            time = std::chrono::duration<double, std::chrono::milliseconds::period>(std::chrono::steady_clock::now() - start).count();
+
+            if (result == VK_SUCCESS)
+            {
+                std::scoped_lock<std::mutex> lock(*_submitMutexes[index]);
+                task->finish(recordedCommandBuffers);
+            }
+        }
+
+        {
+            std::scoped_lock<std::mutex> lock(_mutex);
+            recordTimes[index] += time;
+            maxRecordTimes[index] = std::max(maxRecordTimes[index], time);
+            if (--_pending == 0) _completeCondition.notify_one();
+        }
+    }
+}
+
+void RecordThreads::recordAndSubmit()
+{
+    if (_threads.empty()) return;
+
+    auto start = std::chrono::steady_clock::now();
+
+    {
+        std::scoped_lock<std::mutex> lock(_mutex);
+        _pending = _threads.size();
+        ++_frame;
+    }
+    _startCondition.notify_all();
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _completeCondition.wait(lock, [&]() { return _pending == 0; });
+    }
+
+    frameTime += std::chrono::duration<double, std::chrono::milliseconds::period>(std::chrono::steady_clock::now() - start).count();
+    ++numFrames;
+}
+
+void RecordThreads::report(std::ostream& out) const
+{
+    if (numFrames == 0) return;
+
+    double totalRecordTime = 0.0;
+    for (auto time : recordTimes) totalRecordTime += time;
+
+    out << "RecordThreads numThreads = " << _threads.size() << ", numFrames = " << numFrames << std::endl;
+    out << "    recordAndSubmit " << frameTime / double(numFrames) << "ms/frame, sum of window record times " << totalRecordTime / double(numFrames) << "ms/frame" << std::endl;
+    for (size_t i = 0; i < recordTimes.size(); ++i)
+    {
+        out << "    window " << i << " record " << recordTimes[i] / double(numFrames) << "ms/frame, max " << maxRecordTimes[i] << "ms" << std::endl;
+    }
+}
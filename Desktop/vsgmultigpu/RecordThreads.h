@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vsg/all.h>
+
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+namespace vsg
+{
+
+    //
+    // RecordThreads runs each of the Viewer's RecordAndSubmitTasks on its own long lived thread, with an optional CPU affinity per thread,
+    // so windows record in parallel. Each thread records its task's command graphs without locking, only the submission is serialized,
+    // by a mutex per Queue, to keep vkQueueSubmit externally synchronized. Presentation stays on the Viewer's thread after recordAndSubmit().
+    //
+    class RecordThreads : public Inherit<Object, RecordThreads>
+    {
+    public:
+        // affinities[i] is the CPUs the thread of the Viewer's i'th RecordAndSubmitTask may run on.
+        RecordThreads(Viewer* viewer, const std::vector<Affinity>& affinities);
+
+        // record and submit all the tasks for the current frame, returns once all the threads have finished.
+        void recordAndSubmit();
+
+        void report(std::ostream& out) const;
+
+        // stats, times in milliseconds
+        uint64_t numFrames = 0;
+        double frameTime = 0.0;
+        std::vector<double> recordTimes;
+        std::vector<double> maxRecordTimes;
+
+    protected:
+        virtual ~RecordThreads();
+
+        void run(size_t index, Affinity affinity);
+
+        ref_ptr<Viewer> _viewer;
+
+        std::mutex _mutex;
+        std::condition_variable _startCondition;
+        std::condition_variable _completeCondition;
+        uint64_t _frame = 0;
+        size_t _pending = 0;
+        bool _done = false;
+
+        std::vector<std::mutex*> _submitMutexes;
+        std::map<Queue*, std::mutex> _queueMutexes;
+        std::vector<std::thread> _threads;
+    };
+    VSG_type_name(RecordThreads)
+
+}
@@ -1,40 +1,104 @@
 #include <vsg/all.h>
 
 #include <iostream>
+#include <fstream>
 #include <chrono>
 #include <thread>
 
 #include "AnimationPath.h"
+#include "InstrumentedDatabasePager.h"
+#include "ParallelComputeBounds.h"
+#include "RecordThreads.h"
 
 
-vsg::ref_ptr<vsg::Node> createScene(std::string filename)
+// CPU side data for the built in scene, loaded once and shared by the scene graphs created for each screen
+struct SceneData
+{
+    vsg::ref_ptr<vsg::ShaderStage> vertexShader;
+    vsg::ref_ptr<vsg::ShaderStage> fragmentShader;
+    vsg::ref_ptr<vsg::Data> textureData;
+    vsg::ref_ptr<vsg::vec3Array> vertices;
+    vsg::ref_ptr<vsg::vec3Array> colors;
+    vsg::ref_ptr<vsg::vec2Array> texcoords;
+    vsg::ref_ptr<vsg::ushortArray> indices;
+
+    VkDeviceSize dataSize() const { return textureData->dataSize() + vertices->dataSize() + colors->dataSize() + texcoords->dataSize() + indices->dataSize(); }
+};
+
+bool loadSceneData(SceneData& sceneData)
 {
-    if (!filename.empty())
-    {
-        return vsg::read_cast<vsg::Node>(filename);
-    }
-
     // set up search paths to SPIRV shaders and textures
     vsg::Paths searchPaths = vsg::getEnvPaths("VSG_FILE_PATH");
 
     // load shaders
-    vsg::ref_ptr<vsg::ShaderStage> vertexShader = vsg::ShaderStage::read(VK_SHADER_STAGE_VERTEX_BIT, "main", vsg::findFile("shaders/vert_PushConstants.spv", searchPaths));
-    vsg::ref_ptr<vsg::ShaderStage> fragmentShader = vsg::ShaderStage::read(VK_SHADER_STAGE_FRAGMENT_BIT, "main", vsg::findFile("shaders/frag_PushConstants.spv", searchPaths));
-    if (!vertexShader || !fragmentShader)
+    sceneData.vertexShader = vsg::ShaderStage::read(VK_SHADER_STAGE_VERTEX_BIT, "main", vsg::findFile("shaders/vert_PushConstants.spv", searchPaths));
+    sceneData.fragmentShader = vsg::ShaderStage::read(VK_SHADER_STAGE_FRAGMENT_BIT, "main", vsg::findFile("shaders/frag_PushConstants.spv", searchPaths));
+    if (!sceneData.vertexShader || !sceneData.fragmentShader)
     {
         std::cout<<"Could not create shaders."<<std::endl;
-        return {};
+        return false;
     }
 
     // read texture image
     vsg::Path textureFile("textures/lz.vsgb");
-    auto textureData = vsg::read_cast<vsg::Data>(vsg::findFile(textureFile, searchPaths));
-    if (!textureData)
+    sceneData.textureData = vsg::read_cast<vsg::Data>(vsg::findFile(textureFile, searchPaths));
+    if (!sceneData.textureData)
     {
         std::cout<<"Could not read texture file : "<<textureFile<<std::endl;
-        return {};
+        return false;
     }
 
+    // set up vertex and index arrays
+    sceneData.vertices = vsg::vec3Array::create(
+    {
+        {-0.5f, -0.5f, 0.0f},
+        {0.5f,  -0.5f, 0.05f},
+        {0.5f , 0.5f, 0.0f},
+        {-0.5f, 0.5f, 0.0f},
+        {-0.5f, -0.5f, -0.5f},
+        {0.5f,  -0.5f, -0.5f},
+        {0.5f , 0.5f, -0.5},
+        {-0.5f, 0.5f, -0.5}
+    }); // VK_FORMAT_R32G32B32_SFLOAT, VK_VERTEX_INPUT_RATE_INSTANCE, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE
+
+    sceneData.colors = vsg::vec3Array::create(
+    {
+        {1.0f, 0.0f, 0.0f},
+        {0.0f, 1.0f, 0.0f},
+        {0.0f, 0.0f, 1.0f},
+        {1.0f, 1.0f, 1.0f},
+        {1.0f, 0.0f, 0.0f},
+        {0.0f, 1.0f, 0.0f},
+        {0.0f, 0.0f, 1.0f},
+        {1.0f, 1.0f, 1.0f},
+    }); // VK_FORMAT_R32G32B32_SFLOAT, VK_VERTEX_INPUT_RATE_VERTEX, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE
+
+    sceneData.texcoords = vsg::vec2Array::create(
+    {
+        {0.0f, 0.0f},
+        {1.0f, 0.0f},
+        {1.0f, 1.0f},
+        {0.0f, 1.0f},
+        {0.0f, 0.0f},
+        {1.0f, 0.0f},
+        {1.0f, 1.0f},
+        {0.0f, 1.0f}
+    }); // VK_FORMAT_R32G32_SFLOAT, VK_VERTEX_INPUT_RATE_VERTEX, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE
+
+    sceneData.indices = vsg::ushortArray::create(
+    {
+        0, 1, 2,
+        2, 3, 0,
+        4, 5, 6,
+        6, 7, 4
+    }); // VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE
+
+    return true;
+}
+
+// create the scene graph for the built in scene, the Vulkan objects are created per scene graph while the data is shared
+vsg::ref_ptr<vsg::Node> createScene(const SceneData& sceneData)
+{
     // set up graphics pipeline
     vsg::DescriptorSetLayoutBindings descriptorBindings
     {
@@ -73,11 +137,11 @@ vsg::ref_ptr<vsg::Node> createScene(std::string filename)
     };
 
     auto pipelineLayout = vsg::PipelineLayout::create(vsg::DescriptorSetLayouts{descriptorSetLayout}, pushConstantRanges);
-    auto graphicsPipeline = vsg::GraphicsPipeline::create(pipelineLayout, vsg::ShaderStages{vertexShader, fragmentShader}, pipelineStates);
+    auto graphicsPipeline = vsg::GraphicsPipeline::create(pipelineLayout, vsg::ShaderStages{sceneData.vertexShader, sceneData.fragmentShader}, pipelineStates);
     auto bindGraphicsPipeline = vsg::BindGraphicsPipeline::create(graphicsPipeline);
 
     // create texture image and associated DescriptorSets and binding
-    auto texture = vsg::DescriptorImage::create(vsg::Sampler::create(), textureData, 0, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
+    auto texture = vsg::DescriptorImage::create(vsg::Sampler::create(), sceneData.textureData, 0, 0, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER);
 
     auto descriptorSet = vsg::DescriptorSet::create(descriptorSetLayout, vsg::Descriptors{texture});
     auto bindDescriptorSets = vsg::BindDescriptorSets::create(VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline->getPipelineLayout(), 0, vsg::DescriptorSets{descriptorSet});
@@ -93,55 +157,10 @@ vsg::ref_ptr<vsg::Node> createScene(std::string filename)
     // add transform to root of the scene graph
     scenegraph->addChild(transform);
 
-    // set up vertex and index arrays
-    auto vertices = vsg::vec3Array::create(
-    {
-        {-0.5f, -0.5f, 0.0f},
-        {0.5f,  -0.5f, 0.05f},
-        {0.5f , 0.5f, 0.0f},
-        {-0.5f, 0.5f, 0.0f},
-        {-0.5f, -0.5f, -0.5f},
-        {0.5f,  -0.5f, -0.5f},
-        {0.5f , 0.5f, -0.5},
-        {-0.5f, 0.5f, -0.5}
-    }); // VK_FORMAT_R32G32B32_SFLOAT, VK_VERTEX_INPUT_RATE_INSTANCE, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE
-
-    auto colors = vsg::vec3Array::create(
-    {
-        {1.0f, 0.0f, 0.0f},
-        {0.0f, 1.0f, 0.0f},
-        {0.0f, 0.0f, 1.0f},
-        {1.0f, 1.0f, 1.0f},
-        {1.0f, 0.0f, 0.0f},
-        {0.0f, 1.0f, 0.0f},
-        {0.0f, 0.0f, 1.0f},
-        {1.0f, 1.0f, 1.0f},
-    }); // VK_FORMAT_R32G32B32_SFLOAT, VK_VERTEX_INPUT_RATE_VERTEX, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE
-
-    auto texcoords = vsg::vec2Array::create(
-    {
-        {0.0f, 0.0f},
-        {1.0f, 0.0f},
-        {1.0f, 1.0f},
-        {0.0f, 1.0f},
-        {0.0f, 0.0f},
-        {1.0f, 0.0f},
-        {1.0f, 1.0f},
-        {0.0f, 1.0f}
-    }); // VK_FORMAT_R32G32_SFLOAT, VK_VERTEX_INPUT_RATE_VERTEX, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE
-
-    auto indices = vsg::ushortArray::create(
-    {
-        0, 1, 2,
-        2, 3, 0,
-        4, 5, 6,
-        6, 7, 4
-    }); // VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE
-
     // setup geometry
     auto drawCommands = vsg::Commands::create();
-    drawCommands->addChild(vsg::BindVertexBuffers::create(0, vsg::DataList{vertices, colors, texcoords}));
-    drawCommands->addChild(vsg::BindIndexBuffer::create(indices));
+    drawCommands->addChild(vsg::BindVertexBuffers::create(0, vsg::DataList{sceneData.vertices, sceneData.colors, sceneData.texcoords}));
+    drawCommands->addChild(vsg::BindIndexBuffer::create(sceneData.indices));
     drawCommands->addChild(vsg::DrawIndexed::create(12, 1, 0, 0, 0));
 
     // add drawCommands to transform
@@ -150,6 +169,19 @@ vsg::ref_ptr<vsg::Node> createScene(std::string filename)
     return scenegraph;
 }
 
+vsg::ref_ptr<vsg::Node> createScene(std::string filename)
+{
+    if (!filename.empty())
+    {
+        return vsg::read_cast<vsg::Node>(filename);
+    }
+
+    SceneData sceneData;
+    if (!loadSceneData(sceneData)) return {};
+
+    return createScene(sceneData);
+}
+
 
 int main(int argc, char** argv)
 {
@@ -178,8 +210,14 @@ int main(int argc, char** argv)
     auto horizonMountainHeight = arguments.value(-1.0, "--hmh");
     auto useDatabasePager = arguments.read("--pager");
     auto maxPageLOD = arguments.value(-1, "--max-plod");
+    auto numPagerThreads = arguments.value(0u, "--pager-threads");
+    auto pagerCompileBudget = arguments.value(-1.0, "--pager-budget");
+    auto pagerStatsFilename = arguments.value(std::string(), "--pager-stats");
+    auto numBoundsThreads = arguments.value(0u, "--bounds-threads");
     auto powerWall = arguments.read({"--power-wall","--pw"});
     auto sharedScene = arguments.read({"--shared"});
+    auto shareData = arguments.read({"--share-data"});
+    auto reportTiming = arguments.read("--timing");
 
     std::vector<int> screensToUse;
     int screen = -1;
@@ -200,16 +238,46 @@ int main(int argc, char** argv)
         vsg::setAffinity(affinity);
     }
 
+    // record each window on its own thread, --record-cpu window cpu adds a cpu to that window's record thread affinity
+    auto useRecordThreads = arguments.read("--record-threads");
+    std::vector<vsg::Affinity> recordAffinities;
+    int recordWindow = 0;
+    while(arguments.read("--record-cpu", recordWindow, cpu))
+    {
+        if (recordWindow < 0) continue;
+        if (recordAffinities.size() <= static_cast<size_t>(recordWindow)) recordAffinities.resize(recordWindow+1);
+        recordAffinities[recordWindow].cpus.insert(cpu);
+        useRecordThreads = true;
+    }
+
     // if now screens are assign use screen 0
     if (screensToUse.empty()) screensToUse.push_back(0);
 
 
     if (arguments.errors()) return arguments.writeErrorMessages(std::cerr);
 
+    // any of the pager tuning options enable the InstrumentedDatabasePager
+    bool instrumentPager = numPagerThreads > 0 || pagerCompileBudget >= 0.0 || !pagerStatsFilename.empty();
+    if (instrumentPager) useDatabasePager = true;
+
     vsg::Path filename;
     if (argc>1) filename = arguments[1];
 
-    auto vsg_scene = createScene(filename);
+    // a loaded model can only be shared as a whole, which is what --shared does, so --share-data is limited to the built in scene
+    if (shareData && !filename.empty())
+    {
+        std::cout<<"--share-data only applies to the built in scene, use --shared to share a loaded model between screens."<<std::endl;
+        return 1;
+    }
+
+    auto startSceneSetup = std::chrono::steady_clock::now();
+
+    // with --share-data the built in scene's shaders, texture and geometry arrays are loaded once and shared by each screen's scene graph,
+    // only the Vulkan objects are created per device.
+    SceneData sceneData;
+    if (shareData && !loadSceneData(sceneData)) return 1;
+
+    auto vsg_scene = sceneData.textureData ? createScene(sceneData) : createScene(filename);
     if (!vsg_scene)
     {
         std::cout<<"Unable to load model."<<std::endl;
@@ -217,10 +285,23 @@ int main(int argc, char** argv)
     }
 
     // compute the bounds of the scene graph to help position camera
-    vsg::ComputeBounds computeBounds;
-    vsg_scene->accept(computeBounds);
-    vsg::dvec3 centre = (computeBounds.bounds.min+computeBounds.bounds.max)*0.5;
-    double radius = vsg::length(computeBounds.bounds.max-computeBounds.bounds.min)*0.6;
+    vsg::dbox bounds;
+    if (numBoundsThreads > 0)
+    {
+        auto parallelComputeBounds = vsg::ParallelComputeBounds::create(numBoundsThreads);
+        bounds = parallelComputeBounds->compute(vsg_scene);
+        if (reportTiming) parallelComputeBounds->report(std::cout);
+    }
+    else
+    {
+        vsg::ComputeBounds computeBounds;
+        auto startTime = std::chrono::steady_clock::now();
+        vsg_scene->accept(computeBounds);
+        if (reportTiming) std::cout<<"ComputeBounds time "<<std::chrono::duration<double, std::chrono::milliseconds::period>(std::chrono::steady_clock::now() - startTime).count()<<"ms"<<std::endl;
+        bounds = computeBounds.bounds;
+    }
+    vsg::dvec3 centre = (bounds.min+bounds.max)*0.5;
+    double radius = vsg::length(bounds.max-bounds.min)*0.6;
     double nearFarRatio = 0.0001;
 
     // create master camera
@@ -267,9 +348,20 @@ int main(int argc, char** argv)
 
     // set up database pager
     vsg::ref_ptr<vsg::DatabasePager> databasePager;
+    vsg::ref_ptr<vsg::InstrumentedDatabasePager> instrumentedPager;
     if (useDatabasePager)
     {
-        databasePager = vsg::DatabasePager::create();
+        if (instrumentPager)
+        {
+            instrumentedPager = vsg::InstrumentedDatabasePager::create(numPagerThreads > 0 ? numPagerThreads : 4);
+            instrumentedPager->lookAt = lookAt;
+            if (pagerCompileBudget >= 0.0) instrumentedPager->compileBudget = pagerCompileBudget;
+            databasePager = instrumentedPager;
+        }
+        else
+        {
+            databasePager = vsg::DatabasePager::create();
+        }
         if (maxPageLOD>=0) databasePager->targetMaxNumPagedLODWithHighResSubgraphs = maxPageLOD;
     }
 
@@ -308,14 +400,35 @@ int main(int argc, char** argv)
             camera = vsg::Camera::create(perspective, relative_view, vsg::ViewportState::create(window->extent2D()));
         }
 
-        auto local_scene = sharedScene ? vsg_scene : createScene(filename);
+        vsg::ref_ptr<vsg::Node> local_scene;
+        if (sharedScene || (shareData && i == 0)) local_scene = vsg_scene;
+        else if (shareData) local_scene = createScene(sceneData);
+        else local_scene = createScene(filename);
 
         viewer->assignRecordAndSubmitTaskAndPresentation({vsg::createCommandGraphForView(window, camera, local_scene)}, databasePager);
         viewer->addWindow(window);
+
+        // loaded tiles are compiled for each window's device
+        if (instrumentedPager) instrumentedPager->addWindow(window);
     }
 
+    double sceneSetupTime = std::chrono::duration<double, std::chrono::milliseconds::period>(std::chrono::steady_clock::now()-startSceneSetup).count();
+    if (reportTiming)
+    {
+        std::cout<<"Scene setup time for "<<numScreens<<" screens "<<sceneSetupTime<<"ms"<<std::endl;
+        if (sceneData.textureData) std::cout<<"Shared scene data "<<sceneData.dataSize()<<" bytes"<<std::endl;
+    }
+
+    auto startCompile = std::chrono::steady_clock::now();
+
     viewer->compile();
 
+    double compileTime = std::chrono::duration<double, std::chrono::milliseconds::period>(std::chrono::steady_clock::now()-startCompile).count();
+    if (reportTiming) std::cout<<"Compile time "<<compileTime<<"ms"<<std::endl;
+
+    vsg::ref_ptr<vsg::RecordThreads> recordThreads;
+    if (useRecordThreads) recordThreads = vsg::RecordThreads::create(viewer, recordAffinities);
+
     // rendering main loop
     while (viewer->advanceToNextFrame() && (numFrames<0 || (numFrames--)>0))
     {
@@ -324,11 +437,24 @@ int main(int argc, char** argv)
 
         viewer->update();
 
-        viewer->recordAndSubmit();
+        if (recordThreads) recordThreads->recordAndSubmit();
+        else viewer->recordAndSubmit();
 
         viewer->present();
     }
 
+    if (recordThreads) recordThreads->report(std::cout);
+
+    if (instrumentedPager)
+    {
+        instrumentedPager->report(std::cout);
+        if (!pagerStatsFilename.empty())
+        {
+            std::ofstream statsFile(pagerStatsFilename);
+            instrumentedPager->writeStats(statsFile);
+        }
+    }
+
     // clean up done automatically thanks to ref_ptr<>
     return 0;
 }
@@ -14,6 +14,8 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #include <iostream>
 
+#include "VertexFormat.h"
+
 vsg::ref_ptr<vsg::RenderPass> createRenderPass( vsg::Device* device)
 {
     std::cout<<"myWindowcreate shaders."<<std::endl;
@@ -138,23 +140,12 @@ int main(int argc, char** argv)
             {VK_SHADER_STAGE_VERTEX_BIT, 0, 128} // projection view, and model matrices, actual push constant calls autoaatically provided by the VSG's DispatchTraversal
         };
 
-        vsg::VertexInputState::Bindings vertexBindingsDescriptions
-        {
-            VkVertexInputBindingDescription{0, sizeof(vsg::vec3), VK_VERTEX_INPUT_RATE_VERTEX}, // vertex data
-            VkVertexInputBindingDescription{1, sizeof(vsg::vec3), VK_VERTEX_INPUT_RATE_VERTEX}, // colour data
-            VkVertexInputBindingDescription{2, sizeof(vsg::vec2), VK_VERTEX_INPUT_RATE_VERTEX}  // tex coord data
-        };
-
-        vsg::VertexInputState::Attributes vertexAttributeDescriptions
-        {
-            VkVertexInputAttributeDescription{0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0}, // vertex data
-            VkVertexInputAttributeDescription{1, 1, VK_FORMAT_R32G32B32_SFLOAT, 0}, // colour data
-            VkVertexInputAttributeDescription{2, 2, VK_FORMAT_R32G32_SFLOAT, 0},    // tex coord data
-        };
+        // vertex, colour and tex coord arrays, each in its own binding, formats resolved at compile time
+        using VertexInputs = vsg::VertexArrays<vsg::vec3, vsg::vec3, vsg::vec2>;
 
         vsg::GraphicsPipelineStates pipelineStates
         {
-            vsg::VertexInputState::create( vertexBindingsDescriptions, vertexAttributeDescriptions ),
+            vsg::VertexInputState::create( VertexInputs::bindingDescriptions(), VertexInputs::attributeDescriptions() ),
             vsg::InputAssemblyState::create(),
             vsg::RasterizationState::create(),
             vsg::MultisampleState::create(),
@@ -119,6 +119,8 @@ void AnimationPathHandler::apply(FrameEvent& frame)
         _frameCount = 0;
     }
 
+    _time = time;
+
     dmat4 matrix;
     _path->getMatrix(time, matrix);
 
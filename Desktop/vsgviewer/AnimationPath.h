@@ -66,6 +66,11 @@ namespace vsg
         void apply(KeyPressEvent& keyPress) override;
         void apply(FrameEvent& frame) override;
 
+        ref_ptr<AnimationPath> getAnimationPath() const { return _path; }
+
+        // time along the animation path of the current frame
+        double getTime() const { return _time; }
+
     protected:
         ref_ptr<Camera> _camera;
         ref_ptr<LookAt> _lookAt;
@@ -73,5 +78,6 @@ namespace vsg
         KeySymbol _homeKey = KEY_Space;
         clock::time_point _start_point;
         unsigned int _frameCount = 0;
+        double _time = 0.0;
     };
 }
@@ -0,0 +1,123 @@
+#include "FramePacer.h"
+
+#include <algorithm>
+#include <iostream>
+
+using namespace vsg;
+
+FramePacer::FramePacer(Device* device, uint32_t queueFamily, uint32_t maxFramesInFlight) :
+    _device(device),
+    _queue(device->getQueue(queueFamily)),
+    _maxFramesInFlight(std::max(maxFramesInFlight, 1u)),
+    _sampleTime(clock::now())
+{
+    for (uint32_t i = 0; i < _maxFramesInFlight; ++i)
+    {
+        _fences.push_back(Fence::create(device));
+    }
+
+    _thread = std::thread(&FramePacer::run, this);
+}
+
+FramePacer::~FramePacer()
+{
+    // the completion thread drains the frames still in flight before exiting
+    {
+        std::scoped_lock<std::mutex> lock(_mutex);
+        _done = true;
+    }
+    _condition.notify_all();
+
+    _thread.join();
+}
+
+void FramePacer::run()
+{
+    while (true)
+    {
+        Frame frame;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _condition.wait(lock, [&]() { return _done || !_inFlight.empty(); });
+            if (_inFlight.empty()) return;
+            frame = _inFlight.front();
+        }
+
+        // stamp the completion straight after the wait returns, so the latency isn't inflated by when the main thread gets round to checking
+        VkFence fence = *frame.fence;
+        vkWaitForFences(*_device, 1, &fence, VK_TRUE, 100000000000);
+        auto completeTime = clock::now();
+        vkResetFences(*_device, 1, &fence);
+
+        double latency = std::chrono::duration<double, std::chrono::milliseconds::period>(completeTime - frame.sampleTime).count();
+
+        {
+            std::scoped_lock<std::mutex> lock(_mutex);
+            minLatency = numFrames == 0 ? latency : std::min(minLatency, latency);
+            maxLatency = std::max(maxLatency, latency);
+            totalLatency += latency;
+            ++numFrames;
+
+            _inFlight.pop_front();
+            _fences.push_back(frame.fence);
+        }
+        _condition.notify_all();
+    }
+}
+
+void FramePacer::wait()
+{
+    auto start = clock::now();
+
+    std::unique_lock<std::mutex> lock(_mutex);
+    _condition.wait(lock, [&]() { return _inFlight.size() < _maxFramesInFlight; });
+
+    waitTime += std::chrono::duration<double, std::chrono::milliseconds::period>(clock::now() - start).count();
+}
+
+void FramePacer::sample()
+{
+    _sampleTime = clock::now();
+}
+
+void FramePacer::frameSubmitted()
+{
+    Frame frame;
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _condition.wait(lock, [&]() { return !_fences.empty(); });
+
+        frame = Frame{_fences.back(), _sampleTime};
+        _fences.pop_back();
+    }
+
+    // a submit with no command buffers signals its fence once all previously submitted work on the queue has completed,
+    // submitted through vsg::Queue as the viewer and DatabasePager submit to the same queue from other threads
+    VkSubmitInfo submitInfo = {};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    if (_queue->submit(submitInfo, frame.fence) != VK_SUCCESS)
+    {
+        // the fence will never signal, so return it rather than leave the completion thread waiting on it
+        std::cout << "Warning: FramePacer unable to submit frame fence." << std::endl;
+        std::scoped_lock<std::mutex> lock(_mutex);
+        _fences.push_back(frame.fence);
+        return;
+    }
+
+    {
+        std::scoped_lock<std::mutex> lock(_mutex);
+        _inFlight.push_back(frame);
+    }
+    _condition.notify_all();
+}
+
+void FramePacer::report(std::ostream& out) const
+{
+    std::scoped_lock<std::mutex> lock(_mutex);
+
+    if (numFrames == 0) return;
+
+    out << "FramePacer maxFramesInFlight = " << _maxFramesInFlight << ", numFrames = " << numFrames << std::endl;
+    out << "    sample to GPU complete latency avg " << totalLatency / double(numFrames) << "ms, min " << minLatency << "ms, max " << maxLatency << "ms" << std::endl;
+    out << "    waiting for frames in flight " << waitTime / double(numFrames) << "ms/frame" << std::endl;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <vsg/all.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+namespace vsg
+{
+
+    //
+    // FramePacer limits the number of frames the CPU can queue ahead of the GPU, and measures the latency from the point
+    // where a frame's camera/input state is sampled to when the GPU has completed that frame's work.
+    // Completion is tracked by submitting a fence with no command buffers after each frame, which signals once all prior work on the queue has finished.
+    // A completion thread waits on the fences in submission order and stamps each frame as soon as its fence wait returns.
+    //
+    class FramePacer : public Inherit<Object, FramePacer>
+    {
+    public:
+        FramePacer(Device* device, uint32_t queueFamily, uint32_t maxFramesInFlight);
+
+        using clock = std::chrono::steady_clock;
+
+        // block until fewer than maxFramesInFlight frames are queued on the GPU.
+        void wait();
+
+        // mark the point at which the frame's input was sampled, call just before recordAndSubmit().
+        void sample();
+
+        // submit the fence tracking completion of the frame, call after recordAndSubmit()/present().
+        void frameSubmitted();
+
+        void report(std::ostream& out) const;
+
+        // stats, times in milliseconds
+        uint32_t numFrames = 0;
+        double waitTime = 0.0;
+        double totalLatency = 0.0;
+        double minLatency = 0.0;
+        double maxLatency = 0.0;
+
+    protected:
+        virtual ~FramePacer();
+
+        struct Frame
+        {
+            ref_ptr<Fence> fence;
+            clock::time_point sampleTime;
+        };
+
+        void run();
+
+        ref_ptr<Device> _device;
+        ref_ptr<Queue> _queue;
+        uint32_t _maxFramesInFlight;
+        clock::time_point _sampleTime;
+
+        mutable std::mutex _mutex;
+        std::condition_variable _condition;
+        bool _done = false;
+
+        std::vector<ref_ptr<Fence>> _fences;
+        std::deque<Frame> _inFlight;
+        std::thread _thread;
+    };
+    VSG_type_name(FramePacer)
+
+}
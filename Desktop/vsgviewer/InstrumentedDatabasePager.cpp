@@ -0,0 +1,400 @@
+#include "InstrumentedDatabasePager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+using namespace vsg;
+
+namespace
+{
+    template<typename F>
+    double time(F function)
+    {
+        auto startTime = std::chrono::steady_clock::now();
+        function();
+        return std::chrono::duration<double, std::chrono::milliseconds::period>(std::chrono::steady_clock::now() - startTime).count();
+    }
+
+    // collect the PagedLOD directly below a tile, their own subgraphs are not loaded yet so aren't traversed.
+    struct CollectPagedLODs : public Visitor
+    {
+        std::vector<PagedLOD*> plods;
+
+        void apply(Node& node) override
+        {
+            node.traverse(*this);
+        }
+
+        void apply(PagedLOD& plod) override
+        {
+            plods.push_back(&plod);
+        }
+    };
+}
+
+InstrumentedDatabasePager::InstrumentedDatabasePager(uint32_t numReadThreads)
+{
+    numReadThreads = std::max(numReadThreads, 1u);
+    for (uint32_t i = 0; i < numReadThreads; ++i)
+    {
+        _readThreads.emplace_back(&InstrumentedDatabasePager::read, this);
+    }
+}
+
+InstrumentedDatabasePager::~InstrumentedDatabasePager()
+{
+    {
+        std::scoped_lock<std::mutex> lock(_requestMutex);
+        _done = true;
+    }
+    _requestCondition.notify_all();
+
+    for (auto& thread : _readThreads) thread.join();
+}
+
+void InstrumentedDatabasePager::addWindow(ref_ptr<Window> window)
+{
+    auto device = window->device();
+    auto queueFamily = window->physicalDevice()->getQueueFamily(VK_QUEUE_GRAPHICS_BIT);
+
+    WindowCompile windowCompile;
+    windowCompile.window = window;
+    windowCompile.compileTraversal = new CompileTraversal(device);
+    windowCompile.compileTraversal->context.renderPass = window->renderPass();
+    windowCompile.compileTraversal->context.commandPool = CommandPool::create(device, queueFamily);
+    windowCompile.compileTraversal->context.graphicsQueue = device->getQueue(queueFamily);
+
+    _windowCompiles.push_back(windowCompile);
+}
+
+double InstrumentedDatabasePager::priority(const PagedLOD& plod) const
+{
+    // without an eye point requests are served first come first served
+    if (!_eyeValid) return -double(_requestSequence);
+
+    // the bounding sphere's size relative to its distance is proportional to its projected screen size,
+    // and so to the screen space error of displaying the low resolution child.
+    auto& bound = plod.getBound();
+    double distance = length(bound.center - _eye);
+    return bound.radius / std::max(distance, 1e-6);
+}
+
+void InstrumentedDatabasePager::request(ref_ptr<PagedLOD> plod)
+{
+    {
+        std::scoped_lock<std::mutex> lock(_requestMutex);
+        if (!_requested.insert(plod.get()).second) return;
+
+        plod->requestStatus.exchange(PagedLOD::ReadRequest);
+
+        _requests.push_back(Request{priority(*plod), plod});
+        std::push_heap(_requests.begin(), _requests.end());
+        ++_requestSequence;
+        ++_numRequested;
+    }
+    _requestCondition.notify_one();
+}
+
+void InstrumentedDatabasePager::read()
+{
+    while (true)
+    {
+        ref_ptr<PagedLOD> plod;
+        {
+            std::unique_lock<std::mutex> lock(_requestMutex);
+            _requestCondition.wait(lock, [&]() { return _done || !_requests.empty(); });
+            if (_done) return;
+
+            std::pop_heap(_requests.begin(), _requests.end());
+            plod = _requests.back().plod;
+            _requests.pop_back();
+
+            plod->requestStatus.exchange(PagedLOD::Reading);
+        }
+
+        ref_ptr<Node> node;
+        double readTime = time([&]() { node = read_cast<Node>(plod->filename); });
+
+        if (!node)
+        {
+            std::cout << "Warning: InstrumentedDatabasePager unable to read " << plod->filename << std::endl;
+
+            // the request is complete, so it's no longer in flight. requestCount is left set so the traversals don't request
+            // the failing tile again every frame, the PagedLOD is released with its parent tile's subgraph when that is evicted.
+            std::scoped_lock<std::mutex> lock(_requestMutex);
+            _requested.erase(plod.get());
+            plod->requestStatus.exchange(PagedLOD::NoRequest);
+        }
+
+        if (node) plod->requestStatus.exchange(PagedLOD::MergeRequest);
+
+        std::scoped_lock<std::mutex> lock(_loadedMutex);
+        if (node) _loaded.push_back(LoadedTile{plod, node});
+        ++_numRead;
+        _readTime += readTime;
+    }
+}
+
+void InstrumentedDatabasePager::reserveDescriptors(WindowCompile& windowCompile, Node& node)
+{
+    CollectDescriptorStats collectStats;
+    node.accept(collectStats);
+
+    uint32_t maxSets = collectStats.computeNumDescriptorSets();
+    if (maxSets == 0) return;
+
+    auto poolSizes = collectStats.computeDescriptorPoolSizes();
+
+    bool available = maxSets <= windowCompile.availableSets;
+    for (auto& poolSize : poolSizes)
+    {
+        available = available && poolSize.descriptorCount <= windowCompile.availableDescriptors[poolSize.type];
+    }
+
+    // start a new DescriptorPool, sized for several tiles like this one, once the current one can't fit the tile.
+    // Pools are released once all the DescriptorSets allocated from them have been released with their tiles.
+    if (!available)
+    {
+        uint32_t multiplier = std::max(1u, (descriptorPoolSize + maxSets - 1) / maxSets);
+        for (auto& poolSize : poolSizes) poolSize.descriptorCount *= multiplier;
+
+        auto device = windowCompile.window->device();
+        windowCompile.compileTraversal->context.descriptorPool = DescriptorPool::create(device, maxSets * multiplier, poolSizes);
+        windowCompile.availableSets = maxSets * multiplier;
+        windowCompile.availableDescriptors.clear();
+        for (auto& poolSize : poolSizes) windowCompile.availableDescriptors[poolSize.type] = poolSize.descriptorCount;
+
+        poolSizes = collectStats.computeDescriptorPoolSizes();
+    }
+
+    windowCompile.availableSets -= maxSets;
+    for (auto& poolSize : poolSizes) windowCompile.availableDescriptors[poolSize.type] -= poolSize.descriptorCount;
+}
+
+void InstrumentedDatabasePager::compile(Node& node, double& compileTime)
+{
+    // the transfer commands accumulate in each window's context until submitTransfers()
+    for (auto& windowCompile : _windowCompiles)
+    {
+        reserveDescriptors(windowCompile, node);
+
+        compileTime += time([&]() { node.accept(*windowCompile.compileTraversal); });
+    }
+}
+
+void InstrumentedDatabasePager::submitTransfers(double& transferTime)
+{
+    // one submission per window for all the tiles compiled this frame
+    for (auto& windowCompile : _windowCompiles)
+    {
+        auto& context = windowCompile.compileTraversal->context;
+        if (context.commands.empty()) continue;
+
+        transferTime += time([&]() {
+            auto fence = Fence::create(context.device);
+            submitCommandsToQueue(context.device, context.commandPool, fence, 100000000000, context.graphicsQueue, [&](CommandBuffer& commandBuffer) {
+                for (auto& command : context.commands) command->dispatch(commandBuffer);
+            });
+        });
+
+        context.commands.clear();
+    }
+}
+
+void InstrumentedDatabasePager::merge(LoadedTile& tile, uint64_t frameCount)
+{
+    PagedLOD* plod = tile.plod.get();
+    plod->getChild(0).node = tile.node;
+    plod->requestStatus.exchange(PagedLOD::NoRequest);
+
+    auto& active = _activeTiles[plod];
+    active.mergeFrame = frameCount;
+    auto parent_itr = _parents.find(plod);
+    if (parent_itr != _parents.end())
+    {
+        auto active_parent = _activeTiles.find(parent_itr->second);
+        if (active_parent != _activeTiles.end())
+        {
+            active.parent = parent_itr->second;
+            ++(active_parent->second.numActiveChildren);
+        }
+    }
+
+    // remember which tile the PagedLOD of the new subgraph belong to so tiles are only evicted once their children have been
+    CollectPagedLODs collectPagedLODs;
+    tile.node->accept(collectPagedLODs);
+    for (auto& child : collectPagedLODs.plods) _parents[child] = plod;
+}
+
+void InstrumentedDatabasePager::evict(uint64_t frameCount, uint32_t& numEvicted)
+{
+    if (_activeTiles.size() <= targetMaxNumPagedLODWithHighResSubgraphs) return;
+
+    // only leaf tiles that weren't used in the last frame are candidates, least recently used first
+    std::vector<std::pair<uint64_t, PagedLOD*>> candidates;
+    for (auto& [plod, active] : _activeTiles)
+    {
+        uint64_t lastUsed = std::max(plod->frameHighResLastUsed.load(), active.mergeFrame + unusedTileLifetime);
+        if (active.numActiveChildren == 0 && lastUsed + 1 < frameCount) candidates.emplace_back(lastUsed, plod);
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+
+    for (auto& [lastUsed, plod] : candidates)
+    {
+        if (_activeTiles.size() <= targetMaxNumPagedLODWithHighResSubgraphs) break;
+
+        // keep the subgraph alive until the frames that may still reference it have completed
+        auto& child = plod->getChild(0);
+        _pendingRelease.emplace_back(frameCount, child.node);
+        child.node = {};
+
+        // reset the request state, as DatabasePager does, so the traversals request the tile again when it's next needed
+        plod->requestCount.exchange(0);
+        plod->requestStatus.exchange(PagedLOD::NoRequest);
+
+        {
+            std::scoped_lock<std::mutex> lock(_requestMutex);
+            _requested.erase(plod);
+
+            // drop the outstanding requests for the tile's children
+            auto end = std::remove_if(_requests.begin(), _requests.end(), [&](const Request& request) {
+                auto itr = _parents.find(request.plod.get());
+                if (itr == _parents.end() || itr->second != plod) return false;
+                _requested.erase(request.plod.get());
+                request.plod->requestCount.exchange(0);
+                request.plod->requestStatus.exchange(PagedLOD::NoRequest);
+                return true;
+            });
+            if (end != _requests.end())
+            {
+                _requests.erase(end, _requests.end());
+                std::make_heap(_requests.begin(), _requests.end());
+            }
+        }
+
+        for (auto itr = _parents.begin(); itr != _parents.end();)
+        {
+            if (itr->second == plod) itr = _parents.erase(itr);
+            else ++itr;
+        }
+
+        auto active_itr = _activeTiles.find(plod);
+        if (active_itr->second.parent)
+        {
+            auto active_parent = _activeTiles.find(active_itr->second.parent);
+            if (active_parent != _activeTiles.end()) --(active_parent->second.numActiveChildren);
+        }
+        _activeTiles.erase(active_itr);
+
+        ++numEvicted;
+    }
+}
+
+void InstrumentedDatabasePager::updateSceneGraph(FrameStamp* frameStamp)
+{
+    FrameStats stats;
+    stats.frameCount = frameStamp->frameCount;
+
+    {
+        std::scoped_lock<std::mutex> lock(_requestMutex);
+        if (lookAt)
+        {
+            // reprioritize the outstanding requests from the new eye point
+            _eye = lookAt->eye;
+            _eyeValid = true;
+            for (auto& request : _requests) request.priority = priority(*request.plod);
+            std::make_heap(_requests.begin(), _requests.end());
+        }
+        stats.queueDepth = _requests.size();
+        stats.numRequested = _numRequested;
+        _numRequested = 0;
+    }
+
+    // compile loaded tiles until the budget is used up, then submit their transfers together and merge them
+    std::vector<LoadedTile> compiled;
+    auto startTime = std::chrono::steady_clock::now();
+    while (true)
+    {
+        LoadedTile tile;
+        {
+            std::scoped_lock<std::mutex> lock(_loadedMutex);
+            if (_loaded.empty()) break;
+
+            double elapsed = std::chrono::duration<double, std::chrono::milliseconds::period>(std::chrono::steady_clock::now() - startTime).count();
+            if (stats.numCompiled > 0 && elapsed >= compileBudget) break;
+
+            tile = _loaded.front();
+            _loaded.pop_front();
+        }
+
+        compile(*tile.node, stats.compileTime);
+        compiled.push_back(tile);
+        ++stats.numCompiled;
+    }
+
+    submitTransfers(stats.transferTime);
+
+    stats.mergeTime += time([&]() {
+        for (auto& tile : compiled) merge(tile, stats.frameCount);
+    });
+
+    {
+        std::scoped_lock<std::mutex> lock(_loadedMutex);
+        stats.numRead = _numRead;
+        stats.readTime = _readTime;
+        _numRead = 0;
+        _readTime = 0.0;
+    }
+
+    stats.mergeTime += time([&]() {
+        evict(stats.frameCount, stats.numEvicted);
+
+        while (!_pendingRelease.empty() && _pendingRelease.front().first + releaseDelay <= stats.frameCount)
+        {
+            _pendingRelease.pop_front();
+        }
+    });
+
+    stats.numActiveTiles = _activeTiles.size();
+    frameStats.push_back(stats);
+}
+
+void InstrumentedDatabasePager::writeStats(std::ostream& out) const
+{
+    out << "frame,queueDepth,requested,read,compiled,evicted,activeTiles,readMs,compileMs,transferMs,mergeMs" << std::endl;
+    for (auto& stats : frameStats)
+    {
+        out << stats.frameCount << "," << stats.queueDepth << "," << stats.numRequested << "," << stats.numRead << "," << stats.numCompiled << "," << stats.numEvicted << ","
+            << stats.numActiveTiles << "," << stats.readTime << "," << stats.compileTime << "," << stats.transferTime << "," << stats.mergeTime << std::endl;
+    }
+}
+
+void InstrumentedDatabasePager::report(std::ostream& out) const
+{
+    if (frameStats.empty()) return;
+
+    FrameStats total;
+    size_t maxQueueDepth = 0;
+    double maxFrameTime = 0.0;
+    for (auto& stats : frameStats)
+    {
+        total.numRequested += stats.numRequested;
+        total.numRead += stats.numRead;
+        total.numCompiled += stats.numCompiled;
+        total.numEvicted += stats.numEvicted;
+        total.readTime += stats.readTime;
+        total.compileTime += stats.compileTime;
+        total.transferTime += stats.transferTime;
+        total.mergeTime += stats.mergeTime;
+        maxQueueDepth = std::max(maxQueueDepth, stats.queueDepth);
+        maxFrameTime = std::max(maxFrameTime, stats.compileTime + stats.transferTime + stats.mergeTime);
+    }
+
+    double numFrames = double(frameStats.size());
+    out << "InstrumentedDatabasePager numReadThreads = " << _readThreads.size() << ", compileBudget = " << compileBudget << "ms, numFrames = " << frameStats.size() << std::endl;
+    out << "    requested " << total.numRequested << ", read " << total.numRead << ", compiled " << total.numCompiled << ", evicted " << total.numEvicted << ", active " << frameStats.back().numActiveTiles << ", max queue depth " << maxQueueDepth << std::endl;
+    out << "    read " << total.readTime << "ms on read threads" << std::endl;
+    out << "    compile " << total.compileTime / numFrames << "ms/frame, transfer " << total.transferTime / numFrames << "ms/frame, merge " << total.mergeTime / numFrames << "ms/frame, worst frame " << maxFrameTime << "ms" << std::endl;
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <vsg/all.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace vsg
+{
+
+    //
+    // InstrumentedDatabasePager replaces the DatabasePager's request handling with a configurable number of read threads,
+    // reads the most visually important tiles first from a priority heap, compiles and merges loaded tiles within a per frame time budget
+    // with the transfers of all the tiles compiled in a frame submitted together,
+    // evicts the least recently used leaf tiles beyond targetMaxNumPagedLODWithHighResSubgraphs, and records per frame stats.
+    //
+    class InstrumentedDatabasePager : public Inherit<DatabasePager, InstrumentedDatabasePager>
+    {
+    public:
+        explicit InstrumentedDatabasePager(uint32_t numReadThreads = 4);
+
+        // windows that loaded tiles are compiled for, one per device the scene is rendered on
+        void addWindow(ref_ptr<Window> window);
+
+        // when set requests are prioritized by their screen space size from lookAt->eye, otherwise first come first served
+        ref_ptr<LookAt> lookAt;
+
+        // held whenever request priorities are computed from the PagedLOD bounds, lock it to modify the bounds of PagedLOD in the scene
+        std::mutex& boundMutex() { return _requestMutex; }
+
+        // milliseconds per frame spent compiling and merging loaded tiles, at least one tile is merged per frame
+        double compileBudget = 4.0;
+
+        // number of frames an evicted tile is kept alive for so the GPU has finished with its Vulkan objects
+        uint32_t releaseDelay = 4;
+
+        // number of frames a tile merged ahead of being needed, such as by a prefetch, is protected from eviction
+        uint32_t unusedTileLifetime = 300;
+
+        // minimum number of descriptor sets in each DescriptorPool that tiles are allocated from
+        uint32_t descriptorPoolSize = 256;
+
+        void request(ref_ptr<PagedLOD> plod) override;
+        void updateSceneGraph(FrameStamp* frameStamp) override;
+
+        struct FrameStats
+        {
+            uint64_t frameCount = 0;
+            size_t queueDepth = 0;
+            uint32_t numRequested = 0;
+            uint32_t numRead = 0;
+            uint32_t numCompiled = 0;
+            uint32_t numEvicted = 0;
+            size_t numActiveTiles = 0;
+            double readTime = 0.0;
+            double compileTime = 0.0;
+            double transferTime = 0.0;
+            double mergeTime = 0.0;
+        };
+
+        std::vector<FrameStats> frameStats;
+
+        // write a line per frame of the frameStats in CSV format
+        void writeStats(std::ostream& out) const;
+
+        void report(std::ostream& out) const;
+
+    protected:
+        virtual ~InstrumentedDatabasePager();
+
+        struct LoadedTile
+        {
+            ref_ptr<PagedLOD> plod;
+            ref_ptr<Node> node;
+        };
+
+        struct ActiveTile
+        {
+            PagedLOD* parent = nullptr;
+            uint32_t numActiveChildren = 0;
+            uint64_t mergeFrame = 0;
+        };
+
+        // _requests is a max heap on priority, computed on the main thread when the request is made and each frame the eye moves
+        struct Request
+        {
+            double priority;
+            ref_ptr<PagedLOD> plod;
+
+            bool operator<(const Request& rhs) const { return priority < rhs.priority; }
+        };
+
+        // compile state for each window reused across tiles and frames
+        struct WindowCompile
+        {
+            ref_ptr<Window> window;
+            ref_ptr<CompileTraversal> compileTraversal;
+            uint32_t availableSets = 0;
+            std::map<VkDescriptorType, uint32_t> availableDescriptors;
+        };
+
+        void read();
+        double priority(const PagedLOD& plod) const;
+        void reserveDescriptors(WindowCompile& windowCompile, Node& node);
+        void compile(Node& node, double& compileTime);
+        void submitTransfers(double& transferTime);
+        void merge(LoadedTile& tile, uint64_t frameCount);
+        void evict(uint64_t frameCount, uint32_t& numEvicted);
+
+        std::vector<WindowCompile> _windowCompiles;
+
+        std::mutex _requestMutex;
+        std::condition_variable _requestCondition;
+        std::vector<Request> _requests;
+        std::set<PagedLOD*> _requested;
+        uint64_t _requestSequence = 0;
+        dvec3 _eye;
+        bool _eyeValid = false;
+        bool _done = false;
+
+        std::mutex _loadedMutex;
+        std::deque<LoadedTile> _loaded;
+
+        // stats accumulated by the read threads between frames
+        uint32_t _numRequested = 0;
+        uint32_t _numRead = 0;
+        double _readTime = 0.0;
+
+        std::vector<std::thread> _readThreads;
+
+        // main thread only
+        std::map<PagedLOD*, ActiveTile> _activeTiles;
+        std::map<PagedLOD*, PagedLOD*> _parents;
+        std::deque<std::pair<uint64_t, ref_ptr<Node>>> _pendingRelease;
+    };
+    VSG_type_name(InstrumentedDatabasePager)
+
+}
@@ -0,0 +1,163 @@
+#include "PagedLODPrefetcher.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+using namespace vsg;
+
+namespace
+{
+    // cull the PagedLOD hierarchy from a viewpoint, requesting the high resolution children that would be selected but aren't loaded yet.
+    struct PrefetchCull : public Visitor
+    {
+        DatabasePager* databasePager = nullptr;
+        dvec3 eye;
+        dvec3 forward;
+        double tanHalfFieldOfView = 0.0;
+        double sinHalfViewAngle = 0.0;
+        uint32_t numPagedLODVisited = 0;
+        uint32_t numRequests = 0;
+
+        // local to world matrices of the MatrixTransforms above the current node, starting with the root frame's placement in the world
+        std::vector<dmat4> matrixStack;
+
+        dsphere worldBound(const dsphere& bound) const
+        {
+            auto& matrix = matrixStack.back();
+            double scale = std::max({length(dvec3(matrix[0][0], matrix[0][1], matrix[0][2])),
+                                     length(dvec3(matrix[1][0], matrix[1][1], matrix[1][2])),
+                                     length(dvec3(matrix[2][0], matrix[2][1], matrix[2][2]))});
+            return dsphere(matrix * bound.center, bound.radius * scale);
+        }
+
+        bool visible(const dsphere& bound) const
+        {
+            // conservative cone test, the cone encloses the view frustum
+            dvec3 delta = bound.center - eye;
+            double distance = length(delta);
+            if (distance <= bound.radius) return true;
+
+            double along = dot(delta, forward);
+            if (along < -bound.radius) return false;
+            if (along < 0.0) return true;
+
+            // sin(a + b) <= sin(a) + sin(b) for angles up to 90 degrees, so comparing sines errs on the side of visible
+            double sinAngle = length(cross(delta, forward)) / distance;
+            double sinBound = bound.radius / distance;
+            return sinAngle <= sinHalfViewAngle + sinBound;
+        }
+
+        void apply(Node& node) override
+        {
+            node.traverse(*this);
+        }
+
+        void apply(MatrixTransform& transform) override
+        {
+            matrixStack.push_back(matrixStack.back() * dmat4(transform.getMatrix()));
+            transform.traverse(*this);
+            matrixStack.pop_back();
+        }
+
+        void apply(PagedLOD& plod) override
+        {
+            ++numPagedLODVisited;
+
+            dsphere bound = worldBound(plod.getBound());
+            if (!visible(bound)) return;
+
+            double distance = std::max(length(bound.center - eye), 1e-6);
+            double screenHeightRatio = bound.radius / (distance * tanHalfFieldOfView);
+
+            auto& highRes = plod.getChild(0);
+            if (screenHeightRatio > highRes.minimumScreenHeightRatio)
+            {
+                if (highRes.node)
+                {
+                    highRes.node->accept(*this);
+                }
+                else if (!plod.filename.empty())
+                {
+                    // the same protocol as the traversals, only the first request is passed on and the pager resets the count when it releases the tile
+                    auto previousRequestCount = plod.requestCount.fetch_add(1);
+                    if (previousRequestCount == 0)
+                    {
+                        databasePager->request(ref_ptr<PagedLOD>(&plod));
+                        ++numRequests;
+                    }
+                }
+            }
+        }
+    };
+}
+
+PagedLODPrefetcher::PagedLODPrefetcher(ref_ptr<AnimationPathHandler> animationPathHandler, ref_ptr<Camera> camera, ref_ptr<Node> scene, ref_ptr<DatabasePager> databasePager, double lookAhead, uint32_t in_numSamples) :
+    _animationPathHandler(animationPathHandler),
+    _camera(camera),
+    _scene(scene),
+    _databasePager(databasePager),
+    _lookAhead(lookAhead),
+    _numSamplePoints(std::max(in_numSamples, 1u))
+{
+}
+
+void PagedLODPrefetcher::apply(FrameEvent& /*frame*/)
+{
+    auto path = _animationPathHandler->getAnimationPath();
+    double period = path->getPeriod();
+    if (period <= 0.0) return;
+
+    // cycle through the sample points, nearest first so the tiles needed soonest are requested first
+    uint32_t sample = _nextSample;
+    _nextSample = (_nextSample + 1) % _numSamplePoints;
+
+    double time = _animationPathHandler->getTime() + _lookAhead * double(sample + 1) / double(_numSamplePoints);
+    time = std::fmod(time, period);
+
+    dmat4 matrix;
+    if (!path->getMatrix(time, matrix)) return;
+
+    auto startTime = std::chrono::steady_clock::now();
+
+    // pick up the camera's current field of view and aspect ratio, which change when the window is resized
+    auto projection = _camera->getProjectionMatrix();
+    if (auto perspective = dynamic_cast<Perspective*>(projection.get()))
+    {
+        fieldOfView = perspective->fieldOfViewY;
+        aspectRatio = perspective->aspectRatio;
+    }
+    else if (auto ellipsoidPerspective = dynamic_cast<EllipsoidPerspective*>(projection.get()))
+    {
+        fieldOfView = ellipsoidPerspective->fieldOfViewY;
+        aspectRatio = ellipsoidPerspective->aspectRatio;
+    }
+
+    double halfFieldOfView = radians(fieldOfView) * 0.5;
+    double tanHalfFieldOfView = std::tan(halfFieldOfView);
+    double tanHalfDiagonal = tanHalfFieldOfView * std::sqrt(1.0 + aspectRatio * aspectRatio);
+
+    PrefetchCull cull;
+    cull.databasePager = _databasePager;
+    cull.eye = dvec3(matrix[3][0], matrix[3][1], matrix[3][2]);
+    cull.forward = normalize(-dvec3(matrix[2][0], matrix[2][1], matrix[2][2]));
+    cull.matrixStack.push_back(translate(origin));
+    cull.tanHalfFieldOfView = tanHalfFieldOfView;
+    cull.sinHalfViewAngle = tanHalfDiagonal / std::sqrt(1.0 + tanHalfDiagonal * tanHalfDiagonal);
+
+    _scene->accept(cull);
+
+    cullTime += std::chrono::duration<double, std::chrono::milliseconds::period>(std::chrono::steady_clock::now() - startTime).count();
+    numPagedLODVisited += cull.numPagedLODVisited;
+    numRequests += cull.numRequests;
+    ++numSamples;
+}
+
+void PagedLODPrefetcher::report(std::ostream& out) const
+{
+    if (numSamples == 0) return;
+
+    out << "PagedLODPrefetcher lookAhead = " << _lookAhead << "s, numSamples = " << numSamples << ", PagedLOD visited = " << numPagedLODVisited << ", requests = " << numRequests << std::endl;
+    out << "    cull time " << cullTime / double(numSamples) << "ms/sample" << std::endl;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vsg/all.h>
+
+#include <ostream>
+
+#include "AnimationPath.h"
+
+namespace vsg
+{
+
+    //
+    // PagedLODPrefetcher samples the animation path ahead of the current time and requests the PagedLOD tiles
+    // that will be needed from those future viewpoints, so they are loaded before the camera arrives.
+    // One future viewpoint is culled per frame, cycling through numSamples evenly spaced over the lookAhead period.
+    //
+    class PagedLODPrefetcher : public Inherit<Visitor, PagedLODPrefetcher>
+    {
+    public:
+        PagedLODPrefetcher(ref_ptr<AnimationPathHandler> animationPathHandler, ref_ptr<Camera> camera, ref_ptr<Node> scene, ref_ptr<DatabasePager> databasePager, double lookAhead = 3.0, uint32_t numSamples = 8);
+
+        // vertical field of view in degrees and aspect ratio used to cull and estimate screen height ratios from the future viewpoints,
+        // when the camera's projection is a Perspective or EllipsoidPerspective its values are used instead
+        double fieldOfView = 30.0;
+        double aspectRatio = 16.0 / 9.0;
+
+        // world position of the scene's root coordinate frame, the RelativeToEye origin when rendering relative to the eye.
+        // Applied as a translation above the root, so only bounds in the root frame are moved and those under transforms follow their transforms.
+        dvec3 origin;
+
+        void apply(FrameEvent& frame) override;
+
+        void report(std::ostream& out) const;
+
+        // stats
+        uint32_t numSamples = 0;
+        uint32_t numPagedLODVisited = 0;
+        uint32_t numRequests = 0;
+        double cullTime = 0.0;
+
+    protected:
+        ref_ptr<AnimationPathHandler> _animationPathHandler;
+        ref_ptr<Camera> _camera;
+        ref_ptr<Node> _scene;
+        ref_ptr<DatabasePager> _databasePager;
+        double _lookAhead;
+        uint32_t _numSamplePoints;
+        uint32_t _nextSample = 0;
+    };
+    VSG_type_name(PagedLODPrefetcher)
+
+}
@@ -0,0 +1,228 @@
+#include "ParallelCompile.h"
+
+#include <vsg/nodes/Group.h>
+#include <vsg/nodes/StateGroup.h>
+#include <vsg/traversals/CollectDescriptorStats.h>
+#include <vsg/vk/CommandPool.h>
+#include <vsg/vk/DescriptorPool.h>
+#include <vsg/vk/Fence.h>
+#include <vsg/vk/SubmitCommands.h>
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <set>
+#include <thread>
+
+using namespace vsg;
+
+namespace
+{
+    // record which partition each node belongs to, nodes reachable from more than one partition are collected as shared.
+    struct CollectSharedNodes : public Visitor
+    {
+        std::map<Node*, size_t> owners;
+        std::set<Node*> shared;
+        size_t partition = 0;
+
+        void apply(Node& node) override
+        {
+            auto [itr, inserted] = owners.emplace(&node, partition);
+            if (!inserted)
+            {
+                if (itr->second != partition) shared.insert(&node);
+                return;
+            }
+
+            node.traverse(*this);
+        }
+    };
+
+    // collect the state attached to StateGroups, the same StateCommand, GraphicsPipeline, DescriptorSet or Data may be referenced from
+    // several partitions and their compile isn't thread safe, so all state is compiled on one thread before the nodes are compiled in parallel.
+    struct CollectStateCommands : public Visitor
+    {
+        std::set<Node*> visited;
+        std::vector<ref_ptr<StateCommand>> stateCommands;
+        std::set<StateCommand*> collected;
+
+        void apply(Node& node) override
+        {
+            if (visited.insert(&node).second) node.traverse(*this);
+        }
+
+        void apply(StateGroup& stateGroup) override
+        {
+            if (!visited.insert(&stateGroup).second) return;
+
+            for (auto& stateCommand : stateGroup.getStateCommands())
+            {
+                if (stateCommand && collected.insert(stateCommand.get()).second) stateCommands.push_back(stateCommand);
+            }
+
+            stateGroup.traverse(*this);
+        }
+    };
+
+    template<typename F>
+    double time(F function)
+    {
+        auto startTime = std::chrono::steady_clock::now();
+        function();
+        return std::chrono::duration<double, std::chrono::milliseconds::period>(std::chrono::steady_clock::now() - startTime).count();
+    }
+}
+
+ParallelCompile::ParallelCompile(Window* window, uint32_t numThreads) :
+    _window(window),
+    _numThreads(std::max(numThreads, 1u))
+{
+}
+
+void ParallelCompile::partition(ref_ptr<Node> scene, Subgraphs& subgraphs) const
+{
+    size_t targetNumSubgraphs = _numThreads * subgraphsPerThread;
+
+    subgraphs.push_back(scene);
+
+    bool expanded = true;
+    while (expanded && subgraphs.size() < targetNumSubgraphs)
+    {
+        expanded = false;
+
+        Subgraphs next;
+        for (auto& subgraph : subgraphs)
+        {
+            // StateGroup are kept as a single unit so their state is only ever compiled by one thread.
+            auto group = dynamic_cast<Group*>(subgraph.get());
+            if (group && !dynamic_cast<StateGroup*>(group) && !group->getChildren().empty())
+            {
+                next.insert(next.end(), group->getChildren().begin(), group->getChildren().end());
+                expanded = true;
+            }
+            else
+            {
+                next.push_back(subgraph);
+            }
+        }
+
+        subgraphs.swap(next);
+    }
+}
+
+ref_ptr<CompileTraversal> ParallelCompile::createCompileTraversal() const
+{
+    auto device = _window->device();
+    auto queueFamily = _window->physicalDevice()->getQueueFamily(VK_QUEUE_GRAPHICS_BIT);
+
+    ref_ptr<CompileTraversal> compile(new CompileTraversal(device));
+    compile->context.renderPass = _window->renderPass();
+    compile->context.commandPool = CommandPool::create(device, queueFamily);
+    compile->context.graphicsQueue = device->getQueue(queueFamily);
+
+    return compile;
+}
+
+void ParallelCompile::compile(ref_ptr<Node> scene)
+{
+    if (!scene) return;
+
+    std::vector<Subgraphs> threadSubgraphs(_numThreads);
+    Subgraphs sharedSubgraphs;
+    CollectStateCommands collectState;
+
+    partitionTime = time([&]() {
+        Subgraphs subgraphs;
+        partition(scene, subgraphs);
+        numSubgraphs = subgraphs.size();
+
+        // distribute the subgraphs round robin across the threads
+        for (size_t i = 0; i < subgraphs.size(); ++i)
+        {
+            threadSubgraphs[i % _numThreads].push_back(subgraphs[i]);
+        }
+
+        // nodes shared between threads have to be compiled up front to avoid two threads compiling the same object
+        CollectSharedNodes collectShared;
+        for (size_t t = 0; t < threadSubgraphs.size(); ++t)
+        {
+            collectShared.partition = t;
+            for (auto& subgraph : threadSubgraphs[t]) subgraph->accept(collectShared);
+        }
+
+        for (auto& node : collectShared.shared) sharedSubgraphs.emplace_back(node);
+        numSharedSubgraphs = sharedSubgraphs.size();
+
+        scene->accept(collectState);
+        numStateCommands = collectState.stateCommands.size();
+    });
+
+    std::vector<ref_ptr<CompileTraversal>> compileTraversals;
+
+    // compile all the state and the shared nodes serially, once compiled the worker threads find the Vulkan objects already created
+    // and only read them. Only this traversal gets a DescriptorPool, sized for the whole scene as every DescriptorSet is allocated here.
+    auto sharedCompile = createCompileTraversal();
+
+    CollectDescriptorStats collectStats;
+    scene->accept(collectStats);
+
+    auto maxSets = collectStats.computeNumDescriptorSets();
+    if (maxSets > 0)
+    {
+        sharedCompile->context.descriptorPool = DescriptorPool::create(_window->device(), maxSets, collectStats.computeDescriptorPoolSizes());
+    }
+    sharedCompileTime = time([&]() {
+        for (auto& stateCommand : collectState.stateCommands) stateCommand->compile(sharedCompile->context);
+        for (auto& subgraph : sharedSubgraphs) subgraph->accept(*sharedCompile);
+    });
+    compileTraversals.push_back(sharedCompile);
+
+    // compile each set of subgraphs on its own thread
+    threadCompileTimes.assign(_numThreads, 0.0);
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < _numThreads; ++t)
+    {
+        if (threadSubgraphs[t].empty()) continue;
+
+        auto compile = createCompileTraversal();
+        compileTraversals.push_back(compile);
+
+        threads.emplace_back([this, t, compile, &threadSubgraphs]() {
+            threadCompileTimes[t] = time([&]() {
+                for (auto& subgraph : threadSubgraphs[t]) subgraph->accept(*compile);
+            });
+        });
+    }
+
+    for (auto& thread : threads) thread.join();
+
+    // record the transfer commands from all the threads into one command buffer and submit them as a single batch
+    auto device = _window->device();
+    auto queueFamily = _window->physicalDevice()->getQueueFamily(VK_QUEUE_GRAPHICS_BIT);
+    auto commandPool = CommandPool::create(device, queueFamily);
+    auto fence = Fence::create(device);
+
+    transferTime = time([&]() {
+        submitCommandsToQueue(device, commandPool, fence, 100000000000, device->getQueue(queueFamily), [&](CommandBuffer& commandBuffer) {
+            for (auto& compile : compileTraversals)
+            {
+                for (auto& command : compile->context.commands) command->dispatch(commandBuffer);
+            }
+        });
+    });
+
+    // the transfers have completed so the staging buffers can now be released
+    for (auto& compile : compileTraversals) compile->context.commands.clear();
+}
+
+void ParallelCompile::report(std::ostream& out) const
+{
+    out << "ParallelCompile numThreads = " << _numThreads << ", numSubgraphs = " << numSubgraphs << ", numSharedSubgraphs = " << numSharedSubgraphs << std::endl;
+    out << "    partition time " << partitionTime << "ms" << std::endl;
+    out << "    state and shared compile time " << sharedCompileTime << "ms, numStateCommands = " << numStateCommands << std::endl;
+    for (size_t t = 0; t < threadCompileTimes.size(); ++t)
+    {
+        out << "    thread " << t << " compile time " << threadCompileTimes[t] << "ms" << std::endl;
+    }
+    out << "    batched transfer time " << transferTime << "ms" << std::endl;
+}
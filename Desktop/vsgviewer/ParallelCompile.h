@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vsg/core/Inherit.h>
+#include <vsg/nodes/Node.h>
+#include <vsg/traversals/CompileTraversal.h>
+#include <vsg/viewer/Window.h>
+
+#include <ostream>
+#include <vector>
+
+namespace vsg
+{
+
+    // ParallelCompile partitions a scene graph into independent subgraphs and compiles them on worker threads.
+    // State and nodes shared between subgraphs are compiled serially first so that no two threads compile the same object.
+    // Each worker thread gets its own CompileTraversal with its own CommandPool and staging memory, the DescriptorSets are all allocated
+    // with the state on the main thread from one DescriptorPool sized for the whole scene. The transfer commands collected by all the
+    // workers are then recorded into one command buffer and submitted in a single batch.
+    class ParallelCompile : public Inherit<Object, ParallelCompile>
+    {
+    public:
+        ParallelCompile(Window* window, uint32_t numThreads);
+
+        using Subgraphs = std::vector<ref_ptr<Node>>;
+
+        // split the scene graph into at least subgraphsPerThread * numThreads subgraphs where the graph allows.
+        uint32_t subgraphsPerThread = 4;
+
+        void compile(ref_ptr<Node> scene);
+
+        void report(std::ostream& out) const;
+
+        // stats from the last compile
+        size_t numSubgraphs = 0;
+        size_t numSharedSubgraphs = 0;
+        size_t numStateCommands = 0;
+        double partitionTime = 0.0;
+        double sharedCompileTime = 0.0;
+        std::vector<double> threadCompileTimes;
+        double transferTime = 0.0;
+
+    protected:
+        void partition(ref_ptr<Node> scene, Subgraphs& subgraphs) const;
+        ref_ptr<CompileTraversal> createCompileTraversal() const;
+
+        ref_ptr<Window> _window;
+        uint32_t _numThreads;
+    };
+
+}
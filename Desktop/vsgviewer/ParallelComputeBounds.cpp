@@ -0,0 +1,453 @@
+#include "ParallelComputeBounds.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#    include <xmmintrin.h>
+#    define BOUNDS_USE_SSE
+#endif
+
+using namespace vsg;
+
+namespace
+{
+    struct CachedBounds
+    {
+        dbox bounds;
+        bool cacheable = true;
+    };
+
+    bool valid(const dbox& box)
+    {
+        return box.min.x <= box.max.x;
+    }
+
+    void expand(dbox& box, const dbox& other)
+    {
+        if (!valid(other)) return;
+        box.add(other.min);
+        box.add(other.max);
+    }
+
+    bool getCachedBounds(const Node& node, dbox& box)
+    {
+        bool cached = false;
+        return node.getValue("bounds_valid", cached) && cached && node.getValue("bounds_min", box.min) && node.getValue("bounds_max", box.max);
+    }
+
+    bool isDynamic(const Node& node)
+    {
+        bool dynamic = false;
+        return node.getValue("bounds_dynamic", dynamic) && dynamic;
+    }
+
+    // only Groups carry cached bounds, the bounds of leaves such as Commands and Geometry are only held in the LocalBounds maps for the duration of a compute
+    bool cacheable(const Node& node)
+    {
+        return dynamic_cast<const Group*>(&node) != nullptr;
+    }
+
+    dbox sphereBounds(const dsphere& sphere)
+    {
+        dbox box;
+        if (sphere.radius < 0.0) return box;
+        box.add(sphere.center - dvec3(sphere.radius, sphere.radius, sphere.radius));
+        box.add(sphere.center + dvec3(sphere.radius, sphere.radius, sphere.radius));
+        return box;
+    }
+
+    void setCachedBounds(Node& node, const dbox& box)
+    {
+        node.setValue("bounds_min", box.min);
+        node.setValue("bounds_max", box.max);
+        node.setValue("bounds_valid", true);
+    }
+
+    struct CollectChildren : public Visitor
+    {
+        std::vector<Node*> children;
+
+        void apply(Node& node) override
+        {
+            children.push_back(&node);
+        }
+    };
+
+    // compute the local bounds of subgraphs, recording the bounds of every node visited so they can be cached once all threads have finished.
+    struct LocalBounds : public Visitor
+    {
+        std::map<Node*, CachedBounds> computed;
+        size_t numCachedNodes = 0;
+        size_t numVertices = 0;
+
+        CachedBounds boundsOf(Node& node)
+        {
+            CachedBounds result;
+            if (cacheable(node) && getCachedBounds(node, result.bounds))
+            {
+                ++numCachedNodes;
+                return result;
+            }
+
+            if (auto itr = computed.find(&node); itr != computed.end()) return itr->second;
+
+            auto saved = _current;
+            _current = CachedBounds();
+
+            node.accept(*this);
+
+            result = _current;
+            _current = saved;
+
+            if (isDynamic(node)) result.cacheable = false;
+
+            computed[&node] = result;
+            return result;
+        }
+
+        CachedBounds childBounds(Node& node)
+        {
+            CollectChildren collectChildren;
+            node.traverse(collectChildren);
+
+            CachedBounds result;
+            for (auto child : collectChildren.children)
+            {
+                auto bounds = boundsOf(*child);
+                expand(result.bounds, bounds.bounds);
+                result.cacheable = result.cacheable && bounds.cacheable;
+            }
+            return result;
+        }
+
+        void apply(Node& node) override
+        {
+            CollectChildren collectChildren;
+            node.traverse(collectChildren);
+            if (collectChildren.children.empty())
+            {
+                // leaves this visitor doesn't handle are bounded by vsg::ComputeBounds
+                ComputeBounds computeBounds;
+                node.accept(computeBounds);
+                expand(_current.bounds, computeBounds.bounds);
+                return;
+            }
+
+            applyChildren(node);
+        }
+
+        void applyChildren(Node& node)
+        {
+            auto children = childBounds(node);
+            expand(_current.bounds, children.bounds);
+            _current.cacheable = _current.cacheable && children.cacheable;
+        }
+
+        // nodes that carry their own bounding sphere fall back to it when none of their subgraph's vertex data can be read,
+        // such as quantized vertex arrays or a PagedLOD whose only child is still to be loaded
+        void applyBounded(Node& node, const dsphere& bound)
+        {
+            applyChildren(node);
+            if (!valid(_current.bounds)) _current.bounds = sphereBounds(bound);
+        }
+
+        void apply(CullGroup& cullGroup) override { applyBounded(cullGroup, cullGroup.getBound()); }
+        void apply(CullNode& cullNode) override { applyBounded(cullNode, cullNode.getBound()); }
+        void apply(LOD& lod) override { applyBounded(lod, lod.getBound()); }
+
+        void apply(PagedLOD& plod) override
+        {
+            // the loaded children change as tiles are paged in and out, so don't cache the bounds of paged subgraphs
+            applyBounded(plod, plod.getBound());
+            _current.cacheable = false;
+        }
+
+        void apply(MatrixTransform& transform) override
+        {
+            applyTransform(transform, dmat4(transform.getMatrix()));
+        }
+
+        // bound the transformed corners of the children's local bounding box
+        void applyTransform(Node& transform, const dmat4& matrix)
+        {
+            auto children = childBounds(transform);
+            _current.cacheable = _current.cacheable && children.cacheable;
+            if (!valid(children.bounds)) return;
+
+            auto& box = children.bounds;
+            for (int i = 0; i < 8; ++i)
+            {
+                dvec3 corner((i & 1) ? box.max.x : box.min.x, (i & 2) ? box.max.y : box.min.y, (i & 4) ? box.max.z : box.min.z);
+                _current.bounds.add(matrix * corner);
+            }
+        }
+
+        void apply(BindVertexBuffers& bvb) override
+        {
+            auto& arrays = bvb.getArrays();
+            if (!arrays.empty()) add(arrays[0]);
+        }
+
+        void apply(Geometry& geometry) override
+        {
+            if (!geometry.arrays.empty()) add(geometry.arrays[0]);
+            applyChildren(geometry);
+        }
+
+        void apply(VertexIndexDraw& vid) override
+        {
+            if (!vid.arrays.empty()) add(vid.arrays[0]);
+        }
+
+        void add(Data* data)
+        {
+            if (auto vertices = dynamic_cast<vec3Array*>(data))
+            {
+                expand(_current.bounds, ParallelComputeBounds::bounds(*vertices));
+                numVertices += vertices->valueCount();
+            }
+            else if (auto vertices4 = dynamic_cast<vec4Array*>(data))
+            {
+                for (auto& v : *vertices4) _current.bounds.add(dvec3(v.x, v.y, v.z));
+                numVertices += vertices4->valueCount();
+            }
+            else if (auto dvertices = dynamic_cast<dvec3Array*>(data))
+            {
+                for (auto& v : *dvertices) _current.bounds.add(v);
+                numVertices += dvertices->valueCount();
+            }
+        }
+
+    protected:
+        CachedBounds _current;
+    };
+
+    template<typename F>
+    double time(F function)
+    {
+        auto startTime = std::chrono::steady_clock::now();
+        function();
+        return std::chrono::duration<double, std::chrono::milliseconds::period>(std::chrono::steady_clock::now() - startTime).count();
+    }
+}
+
+ParallelComputeBounds::ParallelComputeBounds(uint32_t numThreads) :
+    _numThreads(std::max(numThreads, 1u))
+{
+}
+
+void ParallelComputeBounds::invalidate(Node& node)
+{
+    // only Groups are cached, so nodes that have never been given a cached bounds are left without the extra user value
+    bool cached = false;
+    if (node.getValue("bounds_valid", cached) && cached) node.setValue("bounds_valid", false);
+}
+
+void ParallelComputeBounds::setDynamic(Node& node)
+{
+    node.setValue("bounds_dynamic", true);
+    invalidate(node);
+}
+
+void ParallelComputeBounds::invalidate(const std::vector<Node*>& nodePath)
+{
+    for (auto node : nodePath) invalidate(*node);
+}
+
+dbox ParallelComputeBounds::bounds(const vec3Array& array)
+{
+    dbox box;
+
+    size_t count = array.valueCount();
+    if (count == 0) return box;
+
+    const float* v = static_cast<const float*>(array.dataPointer());
+    float minValues[3] = {v[0], v[1], v[2]};
+    float maxValues[3] = {v[0], v[1], v[2]};
+
+    size_t i = 0;
+#ifdef BOUNDS_USE_SSE
+    if (count >= 4)
+    {
+        // 4 vertices are 12 floats, loaded as {x0 y0 z0 x1} {y1 z1 x2 y2} {z2 x3 y3 z3} so each lane always holds the same component
+        __m128 minA = _mm_loadu_ps(v), minB = _mm_loadu_ps(v + 4), minC = _mm_loadu_ps(v + 8);
+        __m128 maxA = minA, maxB = minB, maxC = minC;
+
+        for (i = 4; i + 4 <= count; i += 4)
+        {
+            const float* p = v + i * 3;
+            __m128 a = _mm_loadu_ps(p), b = _mm_loadu_ps(p + 4), c = _mm_loadu_ps(p + 8);
+            minA = _mm_min_ps(minA, a);
+            minB = _mm_min_ps(minB, b);
+            minC = _mm_min_ps(minC, c);
+            maxA = _mm_max_ps(maxA, a);
+            maxB = _mm_max_ps(maxB, b);
+            maxC = _mm_max_ps(maxC, c);
+        }
+
+        float mnA[4], mnB[4], mnC[4], mxA[4], mxB[4], mxC[4];
+        _mm_storeu_ps(mnA, minA);
+        _mm_storeu_ps(mnB, minB);
+        _mm_storeu_ps(mnC, minC);
+        _mm_storeu_ps(mxA, maxA);
+        _mm_storeu_ps(mxB, maxB);
+        _mm_storeu_ps(mxC, maxC);
+
+        minValues[0] = std::min({mnA[0], mnA[3], mnB[2], mnC[1]});
+        minValues[1] = std::min({mnA[1], mnB[0], mnB[3], mnC[2]});
+        minValues[2] = std::min({mnA[2], mnB[1], mnC[0], mnC[3]});
+        maxValues[0] = std::max({mxA[0], mxA[3], mxB[2], mxC[1]});
+        maxValues[1] = std::max({mxA[1], mxB[0], mxB[3], mxC[2]});
+        maxValues[2] = std::max({mxA[2], mxB[1], mxC[0], mxC[3]});
+    }
+#endif
+
+    for (; i < count; ++i)
+    {
+        const float* p = v + i * 3;
+        for (int c = 0; c < 3; ++c)
+        {
+            minValues[c] = std::min(minValues[c], p[c]);
+            maxValues[c] = std::max(maxValues[c], p[c]);
+        }
+    }
+
+    box.add(dvec3(minValues[0], minValues[1], minValues[2]));
+    box.add(dvec3(maxValues[0], maxValues[1], maxValues[2]));
+    return box;
+}
+
+dbox ParallelComputeBounds::compute(ref_ptr<Node> scene)
+{
+    dbox result;
+    if (!scene) return result;
+
+    numSubgraphs = numCachedNodes = numComputedNodes = numVertices = 0;
+
+    computeTime = time([&]() {
+        if (cacheable(*scene) && getCachedBounds(*scene, result))
+        {
+            numCachedNodes = 1;
+            return;
+        }
+
+        // expand uncached groups into their children until there are enough subgraphs to keep the threads busy,
+        // transforms are kept whole so every subgraph is in the scene root's coordinate frame.
+        std::vector<Node*> expanded;
+        std::vector<Node*> subgraphs{scene.get()};
+        size_t targetNumSubgraphs = _numThreads * 4;
+
+        bool expanding = true;
+        while (expanding && subgraphs.size() < targetNumSubgraphs)
+        {
+            expanding = false;
+
+            std::vector<Node*> next;
+            for (auto subgraph : subgraphs)
+            {
+                dbox cached;
+                // only plain grouping nodes are expanded, nodes with a transform or their own bounds are reduced whole by LocalBounds
+                bool expandable = dynamic_cast<Group*>(subgraph) && !dynamic_cast<MatrixTransform*>(subgraph) && !dynamic_cast<CullGroup*>(subgraph) && !getCachedBounds(*subgraph, cached);
+
+                CollectChildren collectChildren;
+                if (expandable) subgraph->traverse(collectChildren);
+
+                if (!collectChildren.children.empty())
+                {
+                    expanded.push_back(subgraph);
+                    next.insert(next.end(), collectChildren.children.begin(), collectChildren.children.end());
+                    expanding = true;
+                }
+                else
+                {
+                    next.push_back(subgraph);
+                }
+            }
+
+            subgraphs.swap(next);
+        }
+
+        // remove subgraphs shared between groups so they are only computed once
+        std::sort(subgraphs.begin(), subgraphs.end());
+        subgraphs.erase(std::unique(subgraphs.begin(), subgraphs.end()), subgraphs.end());
+        numSubgraphs = subgraphs.size();
+
+        std::vector<LocalBounds> threadBounds(std::min<size_t>(_numThreads, subgraphs.size()));
+        std::atomic<size_t> nextSubgraph{0};
+
+        std::vector<std::thread> threads;
+        for (size_t t = 1; t < threadBounds.size(); ++t)
+        {
+            threads.emplace_back([&, t]() {
+                for (size_t i = nextSubgraph++; i < subgraphs.size(); i = nextSubgraph++) threadBounds[t].boundsOf(*subgraphs[i]);
+            });
+        }
+
+        for (size_t i = nextSubgraph++; i < subgraphs.size(); i = nextSubgraph++) threadBounds[0].boundsOf(*subgraphs[i]);
+
+        for (auto& thread : threads) thread.join();
+
+        // gather the results, then reduce the expanded groups from the deepest up
+        std::map<Node*, CachedBounds> computed;
+        for (auto& local : threadBounds)
+        {
+            computed.insert(local.computed.begin(), local.computed.end());
+            numCachedNodes += local.numCachedNodes;
+            numVertices += local.numVertices;
+        }
+
+        for (auto subgraph : subgraphs)
+        {
+            if (computed.count(subgraph) == 0)
+            {
+                CachedBounds cached;
+                getCachedBounds(*subgraph, cached.bounds);
+                computed[subgraph] = cached;
+            }
+        }
+
+        for (auto itr = expanded.rbegin(); itr != expanded.rend(); ++itr)
+        {
+            CollectChildren collectChildren;
+            (*itr)->traverse(collectChildren);
+
+            CachedBounds bounds;
+            bounds.cacheable = !isDynamic(**itr);
+            for (auto child : collectChildren.children)
+            {
+                auto& childBounds = computed[child];
+                expand(bounds.bounds, childBounds.bounds);
+                bounds.cacheable = bounds.cacheable && childBounds.cacheable;
+            }
+            computed[*itr] = bounds;
+        }
+
+        numComputedNodes = computed.size();
+
+        for (auto& [node, bounds] : computed)
+        {
+            if (bounds.cacheable && cacheable(*node)) setCachedBounds(*node, bounds.bounds);
+        }
+
+        result = computed[scene.get()].bounds;
+
+        // none of the vertex data could be read, so fall back to the serial vsg::ComputeBounds rather than return invalid bounds
+        if (!valid(result))
+        {
+            ComputeBounds computeBounds;
+            scene->accept(computeBounds);
+            result = computeBounds.bounds;
+        }
+    });
+
+    return result;
+}
+
+void ParallelComputeBounds::report(std::ostream& out) const
+{
+    out << "ParallelComputeBounds numThreads = " << _numThreads << ", numSubgraphs = " << numSubgraphs << ", numComputedNodes = " << numComputedNodes << ", numCachedNodes = " << numCachedNodes << ", numVertices = " << numVertices << std::endl;
+    out << "    compute time " << computeTime << "ms" << std::endl;
+}
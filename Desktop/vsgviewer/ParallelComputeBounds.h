@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vsg/all.h>
+
+#include <map>
+#include <ostream>
+
+namespace vsg
+{
+
+    //
+    // ParallelComputeBounds computes the bounds of a scene graph by splitting it into independent subgraphs that are reduced on worker threads,
+    // with SIMD min/max over the vec3Array vertex data. The local bounds of each Group are cached on it as "bounds" user values,
+    // so later calls only revisit subgraphs that have been invalidated, the bounds of leaves are only held for the duration of a compute.
+    // Transformed subgraphs are bounded by their transformed local bounding box, so the result is conservative but may be looser than vsg::ComputeBounds.
+    //
+    class ParallelComputeBounds : public Inherit<Object, ParallelComputeBounds>
+    {
+    public:
+        explicit ParallelComputeBounds(uint32_t numThreads);
+
+        dbox compute(ref_ptr<Node> scene);
+
+        // remove the cached bounds of the node, callers modifying a subgraph must invalidate each node from the scene root down to the modified node.
+        static void invalidate(Node& node);
+        static void invalidate(const std::vector<Node*>& nodePath);
+
+        // mark a node whose bounds change every frame, such as a transform updated per frame, so neither it nor its ancestors are cached.
+        static void setDynamic(Node& node);
+
+        // SIMD min/max of the array's vertices
+        static dbox bounds(const vec3Array& array);
+
+        void report(std::ostream& out) const;
+
+        // stats from the last compute
+        size_t numSubgraphs = 0;
+        size_t numCachedNodes = 0;
+        size_t numComputedNodes = 0;
+        size_t numVertices = 0;
+        double computeTime = 0.0;
+
+    protected:
+        uint32_t _numThreads;
+    };
+    VSG_type_name(ParallelComputeBounds)
+
+}
@@ -0,0 +1,250 @@
+#include "RelativeToEye.h"
+#include "ParallelComputeBounds.h"
+
+#include <algorithm>
+#include <chrono>
+#include <typeinfo>
+
+using namespace vsg;
+
+namespace
+{
+    // Groups that only collect children or bind state, the children are prepared in their place. Group subclasses such as CullGroup
+    // hold bounds in their parent's coordinates, so aren't passed through.
+    bool isPassThrough(Node* node)
+    {
+        auto& type = typeid(*node);
+        return type == typeid(Group) || type == typeid(StateGroup);
+    }
+
+    // geometry, commands and bounded groups, anything that isn't a pass through group, a MatrixTransform or a PagedLOD, is placed by a wrapping eye relative transform
+    bool isLeaf(Node* node)
+    {
+        return !isPassThrough(node) && !dynamic_cast<MatrixTransform*>(node) && !dynamic_cast<PagedLOD*>(node);
+    }
+
+    template<typename T>
+    void eraseOwned(std::vector<T>& values, const std::vector<PagedLOD*>& owners, PagedLOD* owner)
+    {
+        size_t n = 0;
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            if (owners[i] != owner) values[n++] = values[i];
+        }
+        values.resize(n);
+    }
+}
+
+RelativeToEye::RelativeToEye(ref_ptr<LookAt> lookAt) :
+    viewMatrix(LookAt::create()),
+    _lookAt(lookAt),
+    _origin(lookAt->eye)
+{
+}
+
+ref_ptr<Node> RelativeToEye::prepare(ref_ptr<Node> scene)
+{
+    // a root Group so the scene's own root can be wrapped or replaced like any other child
+    _root = Group::create();
+    _root->addChild(scene);
+    addChildren(*_root, nullptr);
+
+    update();
+
+    return _root;
+}
+
+void RelativeToEye::add(ref_ptr<Node>& node, PagedLOD* owner)
+{
+    if (!node) return;
+
+    if (auto transform = dynamic_cast<MatrixTransform*>(node.get()))
+    {
+        addTransform(ref_ptr<MatrixTransform>(transform), owner);
+    }
+    else if (auto plod = dynamic_cast<PagedLOD*>(node.get()))
+    {
+        addPagedLOD(ref_ptr<PagedLOD>(plod), owner);
+    }
+    else if (isPassThrough(node.get()))
+    {
+        addChildren(static_cast<Group&>(*node), owner);
+    }
+    else
+    {
+        auto wrapper = MatrixTransform::create();
+        wrapper->addChild(node);
+        addTransform(wrapper, owner);
+        node = wrapper;
+    }
+}
+
+void RelativeToEye::addChildren(Group& group, PagedLOD* owner)
+{
+    // consecutive leaf children share one wrapping transform, keeping the order of the children
+    std::vector<ref_ptr<Node>> children;
+    ref_ptr<MatrixTransform> wrapper;
+    for (auto& child : group.getChildren())
+    {
+        if (!child) continue;
+
+        if (isLeaf(child.get()))
+        {
+            if (!wrapper)
+            {
+                wrapper = MatrixTransform::create();
+                addTransform(wrapper, owner);
+                children.push_back(wrapper);
+            }
+            wrapper->addChild(child);
+        }
+        else
+        {
+            wrapper = {};
+            ref_ptr<Node> node = child;
+            add(node, owner);
+            children.push_back(node);
+        }
+    }
+
+    group.getChildren().assign(children.begin(), children.end());
+    ParallelComputeBounds::invalidate(group);
+}
+
+void RelativeToEye::addTransform(ref_ptr<MatrixTransform> transform, PagedLOD* owner)
+{
+    // the transform's subgraph stays in its local coordinates, only its placement in the world becomes eye relative
+    dmat4 world(transform->getMatrix());
+
+    mat4 rotation(world);
+    rotation[3][0] = 0.0f;
+    rotation[3][1] = 0.0f;
+    rotation[3][2] = 0.0f;
+
+    // the matrix is updated every frame, so its bounds must not be cached
+    ParallelComputeBounds::setDynamic(*transform);
+
+    _transforms.push_back(transform);
+    _rotations.push_back(rotation);
+    _translations.push_back(dvec3(world[3][0], world[3][1], world[3][2]));
+    _transformOwners.push_back(owner);
+}
+
+void RelativeToEye::addPagedLOD(ref_ptr<PagedLOD> plod, PagedLOD* owner)
+{
+    _pagedLODs.push_back(plod);
+    _boundCenters.push_back(plod->getBound().center);
+    _pagedLODOwners.push_back(owner);
+
+    // the low resolution child is loaded with the PagedLOD, the high resolution child is paged so belongs to this PagedLOD's tile
+    add(plod->getChild(1).node, owner);
+    add(plod->getChild(0).node, plod.get());
+
+    Tile tile;
+    tile.plod = plod;
+    tile.owner = owner;
+    tile.node = plod->getChild(0).node;
+    _tiles.push_back(tile);
+}
+
+void RelativeToEye::remove(PagedLOD* owner)
+{
+    // remove the tiles nested within the owner's tile first
+    std::vector<PagedLOD*> nested;
+    for (auto& tile : _tiles)
+    {
+        if (tile.owner == owner) nested.push_back(tile.plod.get());
+    }
+    for (auto plod : nested) remove(plod);
+
+    _tiles.erase(std::remove_if(_tiles.begin(), _tiles.end(), [&](const Tile& tile) { return tile.owner == owner; }), _tiles.end());
+
+    eraseOwned(_transforms, _transformOwners, owner);
+    eraseOwned(_rotations, _transformOwners, owner);
+    eraseOwned(_translations, _transformOwners, owner);
+    _transformOwners.erase(std::remove(_transformOwners.begin(), _transformOwners.end(), owner), _transformOwners.end());
+
+    eraseOwned(_pagedLODs, _pagedLODOwners, owner);
+    eraseOwned(_boundCenters, _pagedLODOwners, owner);
+    _pagedLODOwners.erase(std::remove(_pagedLODOwners.begin(), _pagedLODOwners.end(), owner), _pagedLODOwners.end());
+}
+
+void RelativeToEye::update()
+{
+    auto startTime = std::chrono::steady_clock::now();
+
+    // pick up the tiles the pager has merged or released since the last frame
+    std::vector<PagedLOD*> changed;
+    for (auto& tile : _tiles)
+    {
+        if (tile.plod->getChild(0).node != tile.node) changed.push_back(tile.plod.get());
+    }
+
+    for (auto plod : changed)
+    {
+        auto itr = std::find_if(_tiles.begin(), _tiles.end(), [&](const Tile& tile) { return tile.plod.get() == plod; });
+        if (itr == _tiles.end()) continue; // removed along with its parent tile
+
+        remove(plod);
+
+        auto& node = plod->getChild(0).node;
+        add(node, plod);
+        if (node) ++numTilesPrepared;
+
+        // the tiles vector may have been modified, so find the record again
+        itr = std::find_if(_tiles.begin(), _tiles.end(), [&](const Tile& tile) { return tile.plod.get() == plod; });
+        if (itr != _tiles.end()) itr->node = node;
+    }
+
+    // the view keeps the tracked orientation with the eye moved to the origin
+    _origin = _lookAt->eye;
+    viewMatrix->eye = dvec3(0.0, 0.0, 0.0);
+    viewMatrix->center = _lookAt->center - _origin;
+    viewMatrix->up = _lookAt->up;
+
+    // subtract the origin in double then convert to float, in one pass over all the transforms
+    size_t numTransforms = _transforms.size();
+    _relativeTranslations.resize(numTransforms);
+    const dvec3* translations = _translations.data();
+    vec3* relative = _relativeTranslations.data();
+    for (size_t i = 0; i < numTransforms; ++i)
+    {
+        relative[i].x = static_cast<float>(translations[i].x - _origin.x);
+        relative[i].y = static_cast<float>(translations[i].y - _origin.y);
+        relative[i].z = static_cast<float>(translations[i].z - _origin.z);
+    }
+
+    for (size_t i = 0; i < numTransforms; ++i)
+    {
+        mat4 matrix = _rotations[i];
+        matrix[3][0] = relative[i].x;
+        matrix[3][1] = relative[i].y;
+        matrix[3][2] = relative[i].z;
+        _transforms[i]->setMatrix(matrix);
+    }
+
+    {
+        std::unique_lock<std::mutex> lock;
+        if (boundMutex) lock = std::unique_lock<std::mutex>(*boundMutex);
+
+        for (size_t i = 0; i < _pagedLODs.size(); ++i)
+        {
+            dsphere bound = _pagedLODs[i]->getBound();
+            bound.center = _boundCenters[i] - _origin;
+            _pagedLODs[i]->setBound(bound);
+        }
+    }
+
+    double time = std::chrono::duration<double, std::chrono::milliseconds::period>(std::chrono::steady_clock::now() - startTime).count();
+    updateTime += time;
+    maxUpdateTime = std::max(maxUpdateTime, time);
+    ++numFrames;
+}
+
+void RelativeToEye::report(std::ostream& out) const
+{
+    if (numFrames == 0) return;
+
+    out << "RelativeToEye numTransforms = " << _transforms.size() << ", numPagedLOD = " << _pagedLODs.size() << ", tiles prepared = " << numTilesPrepared << std::endl;
+    out << "    update " << updateTime / double(numFrames) << "ms/frame, max " << maxUpdateTime << "ms" << std::endl;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <vsg/all.h>
+
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace vsg
+{
+
+    //
+    // RelativeToEye renders large coordinate scenes, such as whole earth databases, relative to the eye position so the float
+    // matrices pushed to the GPU only hold small translations. World placements are kept in double on the CPU, each frame the eye
+    // position is subtracted in double and only the difference converted to float, for all the transforms in one batched pass.
+    //
+    // The scene is rendered with viewMatrix, which has the eye at the origin, while the tracked LookAt stays in world coordinates
+    // for the camera manipulators. The MatrixTransforms nearest the root take eye relative matrices, geometry not under a transform
+    // is wrapped in an eye relative transform, and PagedLOD bounds at that level are moved into eye coordinates. Paged tiles are
+    // prepared in the same way as they are merged into the scene.
+    //
+    class RelativeToEye : public Inherit<Object, RelativeToEye>
+    {
+    public:
+        explicit RelativeToEye(ref_ptr<LookAt> lookAt);
+
+        // the LookAt to render with, at the origin looking in the same direction as the tracked LookAt
+        ref_ptr<LookAt> viewMatrix;
+
+        // world position the scene is currently rendered relative to
+        const dvec3& origin() const { return _origin; }
+
+        // when set, held while the PagedLOD bounds are moved so other threads reading them, such as the InstrumentedDatabasePager's
+        // request prioritization, don't see a bound part way through an update
+        std::mutex* boundMutex = nullptr;
+
+        // prepare the scene for eye relative rendering, returns the root node to render.
+        ref_ptr<Node> prepare(ref_ptr<Node> scene);
+
+        // call once per frame after the DatabasePager has merged new tiles and before recording, updates the transforms and bounds for the current eye position.
+        void update();
+
+        void report(std::ostream& out) const;
+
+        // stats, times in milliseconds
+        uint64_t numFrames = 0;
+        uint32_t numTilesPrepared = 0;
+        double updateTime = 0.0;
+        double maxUpdateTime = 0.0;
+
+    protected:
+        void add(ref_ptr<Node>& node, PagedLOD* owner);
+        void addChildren(Group& group, PagedLOD* owner);
+        void addTransform(ref_ptr<MatrixTransform> transform, PagedLOD* owner);
+        void addPagedLOD(ref_ptr<PagedLOD> plod, PagedLOD* owner);
+        void remove(PagedLOD* owner);
+
+        ref_ptr<LookAt> _lookAt;
+        dvec3 _origin;
+        ref_ptr<Group> _root;
+
+        // eye relative transforms as struct of arrays, the per frame update is a single pass of double to float conversions
+        std::vector<ref_ptr<MatrixTransform>> _transforms;
+        std::vector<mat4> _rotations;     // world matrix without its translation, converted to float once
+        std::vector<dvec3> _translations; // world translation kept in double
+        std::vector<vec3> _relativeTranslations;
+        std::vector<PagedLOD*> _transformOwners;
+
+        // PagedLOD outside any transform, their bounds are moved into eye coordinates each frame
+        std::vector<ref_ptr<PagedLOD>> _pagedLODs;
+        std::vector<dvec3> _boundCenters;
+        std::vector<PagedLOD*> _pagedLODOwners;
+
+        // the high resolution child last prepared for each PagedLOD, so tiles merged or released by the pager are picked up
+        struct Tile
+        {
+            ref_ptr<PagedLOD> plod;
+            PagedLOD* owner = nullptr;
+            ref_ptr<Node> node;
+        };
+        std::vector<Tile> _tiles;
+    };
+    VSG_type_name(RelativeToEye)
+
+}
@@ -6,10 +6,17 @@
 #endif
 
 #include <iostream>
+#include <fstream>
 #include <chrono>
 #include <thread>
 
 #include "AnimationPath.h"
+#include "FramePacer.h"
+#include "InstrumentedDatabasePager.h"
+#include "PagedLODPrefetcher.h"
+#include "ParallelCompile.h"
+#include "ParallelComputeBounds.h"
+#include "RelativeToEye.h"
 
 int main(int argc, char** argv)
 {
@@ -38,11 +45,30 @@ int main(int argc, char** argv)
     auto horizonMountainHeight = arguments.value(-1.0, "--hmh");
     auto useDatabasePager = arguments.read("--pager");
     auto maxPageLOD = arguments.value(-1, "--max-plod");
+    auto numPagerThreads = arguments.value(0u, "--pager-threads");
+    auto pagerCompileBudget = arguments.value(-1.0, "--pager-budget");
+    auto pagerStatsFilename = arguments.value(std::string(), "--pager-stats");
+    auto prefetchLookAhead = arguments.value(0.0, "--prefetch");
+    auto numPrefetchSamples = arguments.value(8u, "--prefetch-samples");
+    auto numCompileThreads = arguments.value(0, "--compile-threads");
+    auto numBoundsThreads = arguments.value(0u, "--bounds-threads");
+    auto maxFramesInFlight = arguments.value(0u, "--frames-in-flight");
+    auto lateLatch = arguments.read("--late-latch");
+    auto useRelativeToEye = arguments.read("--rte");
+    auto reportTiming = arguments.read("--timing");
     arguments.read("--screen", windowTraits->screenNum);
     arguments.read("--display", windowTraits->display);
 
     if (arguments.errors()) return arguments.writeErrorMessages(std::cerr);
 
+    // any of the pager tuning options enable the InstrumentedDatabasePager
+    bool instrumentPager = numPagerThreads > 0 || pagerCompileBudget >= 0.0 || !pagerStatsFilename.empty();
+    if (instrumentPager) useDatabasePager = true;
+
+    // frame pacing, late latching needs the pacer to wait on so defaults to 2 frames in flight
+    if (lateLatch && maxFramesInFlight == 0) maxFramesInFlight = 2;
+    if (maxFramesInFlight > 0) windowTraits->swapchainPreferences.imageCount = maxFramesInFlight + 1;
+
 #ifdef USE_VSGXCHANGE
     // add use of vsgXchange's support for reading and writing 3rd party file formats
     options->readerWriter = vsgXchange::ReaderWriter_all::create();
@@ -148,10 +174,23 @@ int main(int argc, char** argv)
 
 
     // compute the bounds of the scene graph to help position camera
-    vsg::ComputeBounds computeBounds;
-    vsg_scene->accept(computeBounds);
-    vsg::dvec3 centre = (computeBounds.bounds.min+computeBounds.bounds.max)*0.5;
-    double radius = vsg::length(computeBounds.bounds.max-computeBounds.bounds.min)*0.6;
+    vsg::dbox bounds;
+    if (numBoundsThreads > 0)
+    {
+        auto parallelComputeBounds = vsg::ParallelComputeBounds::create(numBoundsThreads);
+        bounds = parallelComputeBounds->compute(vsg_scene);
+        if (reportTiming) parallelComputeBounds->report(std::cout);
+    }
+    else
+    {
+        vsg::ComputeBounds computeBounds;
+        auto startTime = std::chrono::steady_clock::now();
+        vsg_scene->accept(computeBounds);
+        if (reportTiming) std::cout<<"ComputeBounds time "<<std::chrono::duration<double, std::chrono::milliseconds::period>(std::chrono::steady_clock::now() - startTime).count()<<"ms"<<std::endl;
+        bounds = computeBounds.bounds;
+    }
+    vsg::dvec3 centre = (bounds.min+bounds.max)*0.5;
+    double radius = vsg::length(bounds.max-bounds.min)*0.6;
     double nearFarRatio = 0.0001;
 
     // set up the camera
@@ -169,17 +208,41 @@ int main(int argc, char** argv)
 
     auto camera = vsg::Camera::create(perspective, lookAt, vsg::ViewportState::create(window->extent2D()));
 
+    // render large coordinate scenes relative to the eye, the manipulators keep driving the world space camera
+    vsg::ref_ptr<vsg::RelativeToEye> relativeToEye;
+    auto renderCamera = camera;
+    if (useRelativeToEye)
+    {
+        relativeToEye = vsg::RelativeToEye::create(lookAt);
+        vsg_scene = relativeToEye->prepare(vsg_scene);
+        renderCamera = vsg::Camera::create(perspective, relativeToEye->viewMatrix, vsg::ViewportState::create(window->extent2D()));
+    }
+
     // set up database pager
     vsg::ref_ptr<vsg::DatabasePager> databasePager;
+    vsg::ref_ptr<vsg::InstrumentedDatabasePager> instrumentedPager;
     if (useDatabasePager)
     {
-        databasePager = vsg::DatabasePager::create();
+        if (instrumentPager)
+        {
+            instrumentedPager = vsg::InstrumentedDatabasePager::create(numPagerThreads > 0 ? numPagerThreads : 4);
+            instrumentedPager->addWindow(window);
+            instrumentedPager->lookAt = relativeToEye ? relativeToEye->viewMatrix : lookAt;
+            if (relativeToEye) relativeToEye->boundMutex = &instrumentedPager->boundMutex();
+            if (pagerCompileBudget >= 0.0) instrumentedPager->compileBudget = pagerCompileBudget;
+            databasePager = instrumentedPager;
+        }
+        else
+        {
+            databasePager = vsg::DatabasePager::create();
+        }
         if (maxPageLOD>=0) databasePager->targetMaxNumPagedLODWithHighResSubgraphs = maxPageLOD;
     }
 
     // add close handler to respond the close window button and pressing escape
     viewer->addEventHandler(vsg::CloseHandler::create(viewer));
 
+    vsg::ref_ptr<vsg::PagedLODPrefetcher> prefetcher;
     if (pathFilename.empty())
     {
         viewer->addEventHandler(vsg::Trackball::create(camera));
@@ -196,25 +259,80 @@ int main(int argc, char** argv)
         vsg::ref_ptr<vsg::AnimationPath> animationPath(new vsg::AnimationPath);
         animationPath->read(in);
 
-        viewer->addEventHandler(vsg::AnimationPathHandler::create(camera, animationPath, viewer->start_point()));
+        auto animationPathHandler = vsg::AnimationPathHandler::create(camera, animationPath, viewer->start_point());
+        viewer->addEventHandler(animationPathHandler);
+
+        // request the tiles that will be needed along the path ahead of the camera
+        if (databasePager && prefetchLookAhead > 0.0)
+        {
+            prefetcher = vsg::PagedLODPrefetcher::create(animationPathHandler, camera, vsg_scene, databasePager, prefetchLookAhead, numPrefetchSamples);
+            viewer->addEventHandler(prefetcher);
+        }
     }
 
-    auto commandGraph = vsg::createCommandGraphForView(window, camera, vsg_scene);
+    auto commandGraph = vsg::createCommandGraphForView(window, renderCamera, vsg_scene);
     viewer->assignRecordAndSubmitTaskAndPresentation({commandGraph}, databasePager);
 
+    // compile independent subgraphs on worker threads, viewer->compile() will then only need to compile what remains.
+    if (numCompileThreads > 0)
+    {
+        auto parallelCompile = vsg::ParallelCompile::create(window, numCompileThreads);
+        parallelCompile->compile(vsg_scene);
+        if (reportTiming) parallelCompile->report(std::cout);
+    }
+
     viewer->compile();
 
+    vsg::ref_ptr<vsg::FramePacer> framePacer;
+    if (maxFramesInFlight > 0) framePacer = vsg::FramePacer::create(window->device(), window->physicalDevice()->getQueueFamily(VK_QUEUE_GRAPHICS_BIT), maxFramesInFlight);
+
     // rendering main loop
     while (viewer->advanceToNextFrame() && (numFrames<0 || (numFrames--)>0))
     {
+        if (framePacer)
+        {
+            // wait for a frame slot before sampling input, so the camera recorded is as up to date as possible
+            framePacer->wait();
+
+            // with late latching the events are handled after the wait, appending any input that arrived while waiting to the frame's events
+            // so each event is still handled just once and the camera/view state is set just before recording
+            if (lateLatch) viewer->pollEvents(false);
+        }
+
         // pass any events into EventHandlers assigned to the Viewer
         viewer->handleEvents();
 
         viewer->update();
 
+        if (framePacer) framePacer->sample();
+
+        if (relativeToEye)
+        {
+            relativeToEye->update();
+            if (prefetcher) prefetcher->origin = relativeToEye->origin();
+        }
+
         viewer->recordAndSubmit();
 
         viewer->present();
+
+        if (framePacer) framePacer->frameSubmitted();
+    }
+
+    if (framePacer) framePacer->report(std::cout);
+
+    if (prefetcher) prefetcher->report(std::cout);
+
+    if (relativeToEye) relativeToEye->report(std::cout);
+
+    if (instrumentedPager)
+    {
+        instrumentedPager->report(std::cout);
+        if (!pagerStatsFilename.empty())
+        {
+            std::ofstream statsFile(pagerStatsFilename);
+            instrumentedPager->writeStats(statsFile);
+        }
     }
 
     // clean up done automatically thanks to ref_ptr<>
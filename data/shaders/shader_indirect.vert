@@ -0,0 +1,26 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(push_constant) uniform PushConstants {
+    mat4 projection;
+    mat4 modelview;
+} pc;
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inColor;
+layout(location = 2) in vec2 inTexCoord;
+layout(location = 3) in vec4 inInstance; // per instance xyz position and w scale
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec2 fragTexCoord;
+
+out gl_PerVertex {
+    vec4 gl_Position;
+};
+
+void main() {
+    vec3 position = inPosition * inInstance.w + inInstance.xyz;
+    gl_Position = (pc.projection * pc.modelview) * vec4(position, 1.0);
+    fragColor = inColor;
+    fragTexCoord = inTexCoord;
+}